@@ -2,4 +2,4 @@
 
 #pragma once
 
-int Evaluate(Position* pos, EvalData* e);
\ No newline at end of file
+int Evaluate(Position* pos, EvalData* e, int alpha = -Infinity, int beta = Infinity);
\ No newline at end of file
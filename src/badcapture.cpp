@@ -14,112 +14,140 @@
 #include "bitboard.h"
 #include "bitgen.h"
 #include "badcapture.h"
+#include "publius.h"
+#include "profiler.h"
 
-// IsBadCapture() is used in two places:
-// - in Quiesce() to prune captures that appear 
-//   to lose material
-// - in movepicker.cpp to sort such captures 
-//   below the quiet moves
+#ifdef USE_SEARCH_STATS
+size_t seeCallCount;
+#endif
 
-bool IsBadCapture(Position* pos, Move move) {
+// Captures that appear to lose material are sorted
+// below the quiet moves by MovePicker, and skipped 
+// by quiescence search, unless in check. Most 
+// captures can be accepted without running static 
+// exchange evaluator, based on simple piece values.
 
-    const Square fromSquare = GetFromSquare(move);
-    const Square toSquare = GetToSquare(move);
-    const PieceType hunterType = pos->PieceTypeOnSq(fromSquare);
-    const PieceType preyType = pos->PieceTypeOnSq(toSquare);
+bool IsGoodByValue(const Position* pos, const Move move) {
+
+    const PieceType hunterType = pos->PieceTypeOnSq(GetFromSquare(move));
+    const PieceType preyType = pos->PieceTypeOnSq(GetToSquare(move));
 
     // Good or equal capture, based on simple piece values
     if (pieceValue[preyType] >= pieceValue[hunterType])
-        return false;
+        return true;
 
     // En passant is an equal capture
-    if (GetTypeOfMove(move) == tEnPassant)
-        return false;
-
-    // We must resort to static exchange evaluator
-    return (Swap(pos, fromSquare, toSquare) < 0);
+    return GetTypeOfMove(move) == tEnPassant;
 }
 
 // Static Exchange Evaluator tries to calculate 
 // the value of an exchange on a single square 
 // without playing out the moves. It is blind 
-// to tactics, such as checks, pins, promotions 
-// and overloaded defenders.
+// to tactics, such as checks, pins and overloaded
+// defenders.
 
-int Swap(const Position* pos, const Square fromSquare, const Square toSquare) {
+// We rarely need the exact value of an exchange,
+// only to know whether it reaches some threshold.
+// So instead of building the whole capture sequence 
+// and minimaxing it, SeeGe() keeps the balance from
+// the point of view of the side that made the last 
+// capture and stops as soon as that side can stand 
+// pat with the result on the right side of the 
+// threshold, or cannot recover even if its last
+// capturer survives.
 
-    Color color;
-    int ply, score[32];
-    PieceType hunterType;
-    Bitboard attackers, occupancy, newHunterMap;
+bool SeeGe(const Position* pos, const Move move, const int threshold) {
 
-    attackers = pos->AttacksTo(toSquare);
-    occupancy = pos->Occupied();
+    PROFILE_SCOPE(profSee);
 
-    // Put the value of the piece we are about 
-    // to capture on the stack
-    score[0] = pieceValue[pos->PieceTypeOnSq(toSquare)];
+    const Square fromSquare = GetFromSquare(move);
+    const Square toSquare = GetToSquare(move);
+    Bitboard occupancy = pos->Occupied() ^ Paint(fromSquare);
+    int gain = pieceValue[pos->PieceTypeOnSq(toSquare)];
+    int risk = pieceValue[pos->PieceTypeOnSq(fromSquare)];
+
+#ifdef USE_SEARCH_STATS
+    seeCallCount++;
+#endif
+
+    // En passant removes a pawn from another square, 
+    // which may open a line towards the target square
+    if (GetTypeOfMove(move) == tEnPassant) {
+        gain = pieceValue[Pawn];
+        occupancy ^= Paint(Square(toSquare ^ 8));
+    }
 
-    // Identify the capturing piece
-    hunterType = pos->PieceTypeOnSq(fromSquare);
+    // Promotion adds material, and the promoted piece
+    // is what the opponent can capture
+    if (IsMovePromotion(move)) {
+        gain += pieceValue[GetPromotedPiece(move)] - pieceValue[Pawn];
+        risk = pieceValue[GetPromotedPiece(move)];
+    }
 
-    // Update occupancy map, removing the first capturer
-    occupancy ^= Paint(fromSquare);
+    // Opponent does not recapture and we are still short
+    int balance = gain - threshold;
+    if (balance < 0)
+        return false;
 
-    // Add the attacks by the sliding pieces 
-    // through the first capturer
-    attackers |= (GenerateMoves.Bish(occupancy, toSquare) & pos->AllDiagMovers())
-              | (GenerateMoves.Rook(occupancy, toSquare) & pos->AllStraightMovers());
-    attackers &= occupancy;
+    // Opponent recaptures for free and we are still fine
+    balance = risk - balance;
+    if (balance <= 0)
+        return true;
 
-    // We are now evaluating from the defender's POV
-    color = ~pos->GetSideToMove();
+    // Collect the attackers, including sliding pieces 
+    // attacking through the first capturer
+    Bitboard attackers = pos->AttacksTo(toSquare)
+                       | (GenerateMoves.Bish(occupancy, toSquare) & pos->AllDiagMovers())
+                       | (GenerateMoves.Rook(occupancy, toSquare) & pos->AllStraightMovers());
 
-    // We have completed the capture that is evaluated
-    ply = 1;
+    Color color = pos->GetSideToMove();
+    bool isPassing = true; // does the first capture pass the threshold?
 
-    // Continue looking for the next attacker as long 
-    // as there are the attackers of the right color
-    while (attackers & pos->Pieces(color)) {
+    while (true) {
 
-        // Special treatment of captures by king
-        if (hunterType == King) {
-            score[ply++] = Infinity;
+        // Is there a recapture?
+        color = ~color;
+        attackers &= occupancy;
+        const Bitboard ownAttackers = attackers & pos->Pieces(color);
+        if (!ownAttackers)
             break;
-        }
-        
-        // Update the score
-        score[ply] = -score[ply - 1] + pieceValue[hunterType];
-        
+
+        // With a recapture available, the verdict flips,
+        // unless it turns out that the recapture does not pay
+        isPassing = !isPassing;
+
         // Find the lowest attacker type
+        PieceType hunterType;
+        Bitboard newHunterMap = 0;
         for (hunterType = Pawn; hunterType <= King; ++hunterType)
-            if ((newHunterMap = pos->Map(color, hunterType) & attackers))
+            if ((newHunterMap = pos->Map(color, hunterType) & ownAttackers))
                 break;
 
+        // King may recapture only if there is nothing 
+        // to recapture the king with
+        if (hunterType == King)
+            return (attackers & pos->Pieces(~color)) ? !isPassing : isPassing;
+
+        // If the piece making the capture may be lost without
+        // changing the verdict, the exchange is decided
+        balance = pieceValue[hunterType] - balance;
+        if (balance < (int)isPassing)
+            break;
+
         // Remove the new "hunter" from the occupancy map,
         // one piece at a time (there can be more than one 
         // piece of the same type attacking the toSquare). 
         // This  acts as a replacement of making  a  move.
         occupancy ^= (newHunterMap & -newHunterMap);
-        
+
         // Check if there are new captures available,
         // looking for pieces aligned with the "hunter"
         if (hunterType == Pawn || hunterType == Bishop || hunterType == Queen)
             attackers |= (GenerateMoves.Bish(occupancy, toSquare) & pos->AllDiagMovers());
-        
+
         if (hunterType == Rook || hunterType == Queen)
             attackers |= (GenerateMoves.Rook(occupancy, toSquare) & pos->AllStraightMovers());
-        
-        // Proceed to the next ply
-        attackers &= occupancy;
-        color = ~color;
-        ply++;
     }
 
-    // Minimax the score stack
-    while (--ply)
-        score[ply - 1] = -std::max(-score[ply - 1], score[ply]);
-
-    // Return
-    return score[0];
-}
\ No newline at end of file
+    return isPassing;
+}
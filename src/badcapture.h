@@ -4,7 +4,10 @@
 #pragma once
 
 // piece values for static exchange evaluation
-const int pieceValue[6] = { 100, 300, 300, 500, 900, 0 };
+// (last entry is for noPieceType, i.e. non-captures)
+const int pieceValue[7] = { 100, 300, 300, 500, 900, 0, 0 };
 
-bool IsBadCapture(Position* pos, Move move);
-int Swap(const Position* pos, const Square fromSquare, const Square toSquare);
+extern size_t seeCallCount; // with USE_SEARCH_STATS, read by Bench()
+
+bool IsGoodByValue(const Position* pos, const Move move);
+bool SeeGe(const Position* pos, const Move move, const int threshold);
@@ -1,10 +1,18 @@
 // Publius - Didactic public domain bitboard chess engine
 // by Pawel Koziol
 
+#include <string>
 #include "types.h"
 #include "square.h" // for rank and file
+#include "limits.h"
+#include "position.h"
 #include "bitboard.h"
 #include "bitgen.h"
+#include "publius.h" // for USE_PEXT
+
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
 
 // Bitgen class implements move generation.
 
@@ -19,10 +27,94 @@
 // and boiled down to the interesting bits only
 // (i.e. to bits that influence the move range).
 
+// Alternatively, sliding moves can be generated
+// using magic bitboards or BMI2 PEXT instruction.
+// Both need bigger tables, but do a single lookup
+// per slider. Tables are built once at startup,
+// using kindergarten attacks as a reference.
+
 static constexpr Bitboard bbRank1 = 0x00000000000000FFULL;
 static constexpr Bitboard bbFileA = 0x0101010101010101ULL;
 static constexpr Bitboard bbFileB = 0x0202020202020202ULL;
 static constexpr Bitboard bbB8H2diag = 0x0204081020408000ULL;
+static constexpr Bitboard bbFileH = bbFileA << 7;
+static constexpr Bitboard bbRank8 = bbRank1 << 56;
+static constexpr Bitboard bbEdges = bbFileA | bbFileH | bbRank1 | bbRank8;
+
+// Fancy magic bitboards: every square owns a slice
+// of a shared attack table. Slice index is calculated
+// from the relevant occupancy (board edges excluded,
+// since they never influence the move range), either
+// by magic multiplication and shift or by PEXT.
+
+struct SliderEntry {
+    Bitboard mask;         // relevant occupancy
+    Bitboard magic;
+    Bitboard* attacks;     // slice of magicTable
+    Bitboard* pextAttacks; // slice of pextTable
+    int shift;
+};
+
+static constexpr int bishopTableSize = 5248;
+static constexpr int rookTableSize = 102400;
+
+static SliderEntry bishopEntries[64];
+static SliderEntry rookEntries[64];
+static Bitboard magicTable[bishopTableSize + rookTableSize]; // 841 KB
+#ifdef USE_PEXT
+static Bitboard pextTable[bishopTableSize + rookTableSize];  // another 841 KB
+#endif
+
+// Magic numbers, found by trial and error with random
+// sparse numbers, as first proposed by Pradyumna Kannan
+
+static constexpr Bitboard bishopMagics[64] = {
+    0x0004208202020010ULL, 0x0002080124008080ULL, 0x0050040062432824ULL, 0x0A08049100301065ULL,
+    0x0024106860501009ULL, 0x2001012010082820ULL, 0x8009080242A000B1ULL, 0x0400110802100500ULL,
+    0x0A02841004082090ULL, 0x4004600404104040ULL, 0x0000410901050060ULL, 0x00040808410003CDULL,
+    0x0482084840004600ULL, 0x0180411028344845ULL, 0x002000881148202CULL, 0x110101410411200EULL,
+    0x8142001050010112ULL, 0x0048042041210200ULL, 0x4808040400451600ULL, 0x800804C422042040ULL,
+    0x0084206202010000ULL, 0x420202004100A000ULL, 0x0004041200A2080CULL, 0x000720A114060210ULL,
+    0x000222009004100EULL, 0x00082000AC058220ULL, 0x8001010210004208ULL, 0x8812008048008082ULL,
+    0x4042940005802000ULL, 0x001000802B089000ULL, 0x4120809101041010ULL, 0xC001002411040100ULL,
+    0x0010020829101040ULL, 0x0806012009308201ULL, 0x4500840440100241ULL, 0x8008020080080080ULL,
+    0x0040020201002080ULL, 0x0010004110020101ULL, 0x001009004006020CULL, 0x0888010041011040ULL,
+    0x0004320240025006ULL, 0x0082008484042002ULL, 0x400200540C003600ULL, 0x1000020A44004800ULL,
+    0x0888080104440400ULL, 0x4040010040800504ULL, 0x8030120200480401ULL, 0xA021342110402200ULL,
+    0x020A109008080080ULL, 0x000A242404040400ULL, 0x8000608404096100ULL, 0x0066100084040002ULL,
+    0x000020501A022602ULL, 0x1028425002008101ULL, 0x20502088490040A0ULL, 0x001001520C04500AULL,
+    0x0601008044224044ULL, 0x0000404048041000ULL, 0x0100008020841000ULL, 0x3050090000420218ULL,
+    0x0040000210020E10ULL, 0x8004010410428208ULL, 0x0000110510008209ULL, 0x6008020094010A00ULL
+};
+
+static constexpr Bitboard rookMagics[64] = {
+    0x0080001028804001ULL, 0x0140014050002000ULL, 0x0A000A2201401080ULL, 0x0200100408204200ULL,
+    0x0100040800021100ULL, 0x3900010004000208ULL, 0x94801A0001000080ULL, 0x0200090040840422ULL,
+    0x0400800080204001ULL, 0x8204400820005004ULL, 0x0000801000200080ULL, 0x0002001240200A00ULL,
+    0x0000800800800400ULL, 0x0015004401000802ULL, 0x4801010004010200ULL, 0x21020009244A0084ULL,
+    0x8080004020004000ULL, 0x0009010030400080ULL, 0x4020028022100082ULL, 0x0000808008001000ULL,
+    0x0820808008000400ULL, 0xA800808002000400ULL, 0x0000040021020850ULL, 0x0108020000910044ULL,
+    0x0D80208080004010ULL, 0x4300200140100040ULL, 0x0100200080801000ULL, 0x0018100080080080ULL,
+    0x0040040080800800ULL, 0xA802040080800200ULL, 0x0000100402020008ULL, 0x1005010200008044ULL,
+    0x000081C004800020ULL, 0x4110002000400040ULL, 0xC200401202002081ULL, 0x0100100080800802ULL,
+    0x022601100A000420ULL, 0x0006001002000804ULL, 0x0046000402000801ULL, 0x1410084122001084ULL,
+    0x0000209040088000ULL, 0x0000201000404001ULL, 0x0680100020008080ULL, 0x0010008100080800ULL,
+    0x1008000501090010ULL, 0x0002000410020008ULL, 0x0040020004010100ULL, 0x100001005082000CULL,
+    0x000220804A070200ULL, 0x0040200040008080ULL, 0x0020008020100080ULL, 0x0C00100100082500ULL,
+    0x1208080004008080ULL, 0x0001840082008080ULL, 0x00001201B0084400ULL, 0x000041009C004A00ULL,
+    0x001C190080024161ULL, 0x0440400480142103ULL, 0x0000094012802202ULL, 0x400410008D002029ULL,
+    0x0009000402100801ULL, 0x800200106318040AULL, 0x4040080090020144ULL, 0x4080090400204482ULL
+};
+
+static inline Bitboard MagicAttacks(const SliderEntry& entry, const Bitboard occ) {
+    return entry.attacks[((occ & entry.mask) * entry.magic) >> entry.shift];
+}
+
+#ifdef USE_PEXT
+static inline Bitboard PextAttacks(const SliderEntry& entry, const Bitboard occ) {
+    return entry.pextAttacks[_pext_u64(occ, entry.mask)];
+}
+#endif
 
 void MoveGenerator::Init() {
 
@@ -35,6 +127,89 @@ void MoveGenerator::Init() {
     }
 
     InitRankAndFileAttacks(); // kindergarten bitboards
+    InitSliderTables(); // magic and PEXT bitboards
+    sliderType = sliderMagic;
+}
+
+// Fill magic (and PEXT) tables with attacks for every
+// subset of relevant occupancy, enumerated using
+// Carry-Rippler trick.
+void MoveGenerator::InitSliderTables() {
+
+    Bitboard* bishopSlice = magicTable;
+    Bitboard* rookSlice = magicTable + bishopTableSize;
+#ifdef USE_PEXT
+    Bitboard* bishopPextSlice = pextTable;
+    Bitboard* rookPextSlice = pextTable + bishopTableSize;
+#endif
+
+    for (Square sq = A1; sq < sqNone; ++sq) {
+
+        SliderEntry& bishop = bishopEntries[sq];
+        SliderEntry& rook = rookEntries[sq];
+
+        bishop.mask = (diagonalMask[sq] | antiDiagMask[sq]) & ~bbEdges & ~Paint(sq);
+        bishop.magic = bishopMagics[sq];
+        bishop.shift = 64 - PopCnt(bishop.mask);
+        bishop.attacks = bishopSlice;
+        bishop.pextAttacks = nullptr;
+
+        rook.mask = ((rankMask[sq] & ~(bbFileA | bbFileH)) 
+                  | (fileMask[sq] & ~(bbRank1 | bbRank8))) & ~Paint(sq);
+        rook.magic = rookMagics[sq];
+        rook.shift = 64 - PopCnt(rook.mask);
+        rook.attacks = rookSlice;
+        rook.pextAttacks = nullptr;
+
+#ifdef USE_PEXT
+        bishop.pextAttacks = bishopPextSlice;
+        rook.pextAttacks = rookPextSlice;
+#endif
+
+        Bitboard occ = 0;
+        do {
+            const Bitboard att = DiagAttacks(occ, sq) | AntiDiagAttacks(occ, sq);
+            bishop.attacks[((occ * bishop.magic) >> bishop.shift)] = att;
+#ifdef USE_PEXT
+            bishop.pextAttacks[_pext_u64(occ, bishop.mask)] = att;
+#endif
+            occ = (occ - bishop.mask) & bishop.mask;
+        } while (occ);
+
+        occ = 0;
+        do {
+            const Bitboard att = FileAttacks(occ, sq) | RankAttacks(occ, sq);
+            rook.attacks[((occ * rook.magic) >> rook.shift)] = att;
+#ifdef USE_PEXT
+            rook.pextAttacks[_pext_u64(occ, rook.mask)] = att;
+#endif
+            occ = (occ - rook.mask) & rook.mask;
+        } while (occ);
+
+        bishopSlice += 1ULL << (64 - bishop.shift);
+        rookSlice += 1ULL << (64 - rook.shift);
+#ifdef USE_PEXT
+        bishopPextSlice += 1ULL << (64 - bishop.shift);
+        rookPextSlice += 1ULL << (64 - rook.shift);
+#endif
+    }
+}
+
+// Returns false if requested generator
+// has not been compiled in
+bool MoveGenerator::SetSliderType(const SliderType type) {
+
+#ifndef USE_PEXT
+    if (type == sliderPext)
+        return false;
+#endif
+
+    sliderType = type;
+    return true;
+}
+
+SliderType MoveGenerator::GetSliderType() {
+    return sliderType;
 }
 
 void MoveGenerator::InitPawnAttacks(const Square sq, const Bitboard b) {
@@ -149,11 +324,25 @@ Bitboard MoveGenerator::Knight(const Square sq) {
 };
 
 Bitboard MoveGenerator::Bish(const Bitboard occ, const Square sq) {
-    return DiagAttacks(occ, sq) | AntiDiagAttacks(occ, sq);
+
+    switch (sliderType) {
+    case sliderMagic: return MagicAttacks(bishopEntries[sq], occ);
+#ifdef USE_PEXT
+    case sliderPext: return PextAttacks(bishopEntries[sq], occ);
+#endif
+    default: return DiagAttacks(occ, sq) | AntiDiagAttacks(occ, sq);
+    }
 }
 
 Bitboard MoveGenerator::Rook(const Bitboard occ, const Square sq) {
-    return FileAttacks(occ, sq) | RankAttacks(occ, sq);
+
+    switch (sliderType) {
+    case sliderMagic: return MagicAttacks(rookEntries[sq], occ);
+#ifdef USE_PEXT
+    case sliderPext: return PextAttacks(rookEntries[sq], occ);
+#endif
+    default: return FileAttacks(occ, sq) | RankAttacks(occ, sq);
+    }
 }
 
 Bitboard MoveGenerator::Queen(const Bitboard occ, const Square sq) {
@@ -2,8 +2,17 @@
 
 #pragma once
 
+// Sliding piece attack generators. Kindergarten bitboards
+// need the smallest tables, magic bitboards do a single
+// lookup per piece, PEXT replaces magic multiplication
+// with a BMI2 instruction and needs USE_PEXT (see publius.h)
+
+enum SliderType { sliderKindergarten, sliderMagic, sliderPext, sliderTypeCount };
+inline constexpr const char* sliderNames[sliderTypeCount] = { "kindergarten", "magic", "pext" };
+
 class MoveGenerator {
 private:
+    SliderType sliderType;
     Bitboard pawnAttacks[2][64];
     Bitboard knightAttacks[64];
     Bitboard kingAttacks[64];
@@ -22,8 +31,11 @@ private:
     Bitboard DiagAttacks(const Bitboard occ, const Square sq);
     Bitboard AntiDiagAttacks(const Bitboard occ, const Square sq);
     void InitRankAndFileAttacks();
+    void InitSliderTables(void);
 public:
     void Init(void);
+    bool SetSliderType(const SliderType type);
+    SliderType GetSliderType(void);
     Bitboard Pawn(const Color color, const Square sq);
     Bitboard Knight(const Square sq);
     Bitboard Bish(const Bitboard occ, const Square sq);
@@ -0,0 +1,199 @@
+// Publius - Didactic public domain bitboard chess engine
+// by Pawel Koziol
+
+// CapturePicker serves captures in the late quiescence search,
+// which is where most of the nodes are. See capturepicker.h
+// for an overview. Compared with MovePicker, it does not use
+// any move list: the state is just a few bitboards, so that
+// generation can stop at any point without wasted work.
+
+#include "types.h"
+#include "position.h"
+#include "bitboard.h"
+#include "mask.h"
+#include "bitgen.h"
+#include "move.h"
+#include "legality.h"
+#include "badcapture.h"
+#include "capturepicker.h"
+
+void CapturePicker::Init(const Move ttMove) {
+
+    moveFromTT = ttMove;
+    stage = captureTT;
+}
+
+// Emits the next move
+Move CapturePicker::NextMove(Position* pos) {
+
+    const CheckData* cd = pos->GetCheckData();
+    const Color color = pos->GetSideToMove();
+    Move move;
+
+    while (true) {
+        switch (stage) {
+            case captureTT:
+            {
+                stage = captureVictims;
+                attacked = Attacked(pos);
+                victimType = Queen;
+                victims = pos->Map(~color, Queen) & attacked;
+                hunters = 0;
+
+                if (moveFromTT &&
+                    IsPseudoLegal(pos, moveFromTT) &&
+                    IsLegal(pos, cd, moveFromTT))
+                    return moveFromTT;
+                break;
+            }
+
+            case captureVictims:
+            {
+                // Try the remaining attackers of the current
+                // victim, the least valuable one first
+                while (hunters) {
+                    while (!(hunters & pos->Map(color, hunterType)))
+                        ++hunterType;
+
+                    fromSquare = FirstOne(hunters & pos->Map(color, hunterType));
+                    hunters ^= Paint(fromSquare);
+                    move = CreateMove(fromSquare, toSquare, flag);
+
+                    if (move == moveFromTT)
+                        continue;
+
+                    if (flag == tEnPassant &&
+                        !IsEnPassantLegal(pos, fromSquare, toSquare))
+                        continue;
+
+                    if (IsGood(pos, move))
+                        return move;
+                }
+
+                // Next victim of the current type
+                if (victims) {
+                    toSquare = PopFirstBit(&victims);
+                    flag = tNormal;
+                    hunters = Hunters(pos, cd, toSquare);
+                    hunterType = Pawn;
+
+                    // Only pawns capture en passant
+                    if (toSquare == pos->EnPassantSq()) {
+                        flag = tEnPassant;
+                        hunters &= pos->Map(color, Pawn);
+                    }
+                    break;
+                }
+
+                // Having tried all the victims of the current type,
+                // we move on to the next (less valuable) type
+                if (victimType > Pawn) {
+                    victimType = PieceType(victimType - 1);
+                    victims = pos->Map(~color, victimType) & attacked;
+
+                    // En passant is a pawn capturing a pawn
+                    if (victimType == Pawn && pos->EnPassantSq() != sqNone)
+                        victims |= Paint(pos->EnPassantSq());
+                    break;
+                }
+
+                stage = capturePromotion;
+                promoters = pos->Map(color, Pawn) & Mask.rank[color == White ? rank7 : rank2];
+                promotionTargets = 0;
+                break;
+            }
+
+            case capturePromotion:
+            {
+                while (promotionTargets) {
+                    move = CreateMove(fromSquare, PopFirstBit(&promotionTargets), tPromQ);
+                    if (move != moveFromTT && IsGood(pos, move))
+                        return move;
+                }
+
+                if (!promoters) {
+                    stage = captureEnd;
+                    break;
+                }
+
+                // Promotion with capture or by moving forward
+                fromSquare = PopFirstBit(&promoters);
+                promotionTargets = (GenerateMoves.Pawn(color, fromSquare) & pos->Pieces(~color))
+                                 | (Paint(Square(fromSquare + (color == White ? 8 : -8))) & pos->Empty());
+
+                // Pinned pawn may move only along the pin line
+                if (cd->pinned & Paint(fromSquare))
+                    promotionTargets &= Mask.line[cd->kingSq][fromSquare];
+                break;
+            }
+
+            case captureEnd:
+                return 0;
+        }
+    }
+}
+
+// Enemy pieces (except the king) that we attack, regardless 
+// of pins. Pawns that can promote are handled separately.
+Bitboard CapturePicker::Attacked(Position* pos) {
+
+    const Color color = pos->GetSideToMove();
+    const Bitboard occ = pos->Occupied();
+    const Bitboard pawns = pos->Map(color, Pawn) & ~Mask.rank[color == White ? rank7 : rank2];
+    Bitboard pieces, result;
+
+    result = (color == White) ? GetWPAttacks(pawns) : GetBPAttacks(pawns);
+    result |= GenerateMoves.King(pos->KingSq(color));
+
+    pieces = pos->Map(color, Knight);
+    while (pieces)
+        result |= GenerateMoves.Knight(PopFirstBit(&pieces));
+
+    pieces = pos->MapDiagonalSliders(color);
+    while (pieces)
+        result |= GenerateMoves.Bish(occ, PopFirstBit(&pieces));
+
+    pieces = pos->MapStraightSliders(color);
+    while (pieces)
+        result |= GenerateMoves.Rook(occ, PopFirstBit(&pieces));
+
+    return result & pos->Pieces(~color) & ~pos->Map(~color, King);
+}
+
+// Pieces that can legally capture on the target square.
+// We are not in check, so only pins and safety of
+// the king's destination matter.
+Bitboard CapturePicker::Hunters(Position* pos, const CheckData* cd, const Square target) {
+
+    const Color color = pos->GetSideToMove();
+    const Bitboard occ = pos->Occupied();
+    Bitboard result, pinned;
+
+    // Pawns that can promote are handled separately
+    result = pos->Map(color, Pawn) & GenerateMoves.Pawn(~color, target)
+           & ~Mask.rank[color == White ? rank7 : rank2];
+    result |= pos->Map(color, Knight) & GenerateMoves.Knight(target);
+    result |= pos->MapDiagonalSliders(color) & GenerateMoves.Bish(occ, target);
+    result |= pos->MapStraightSliders(color) & GenerateMoves.Rook(occ, target);
+
+    if ((GenerateMoves.King(target) & Paint(cd->kingSq)) && IsKingMoveLegal(pos, target))
+        result |= Paint(cd->kingSq);
+
+    // Pinned pieces may capture only along the pin line
+    pinned = result & cd->pinned;
+    while (pinned) {
+        const Square pinnedSquare = PopFirstBit(&pinned);
+        if (!(Mask.line[cd->kingSq][pinnedSquare] & Paint(target)))
+            result ^= Paint(pinnedSquare);
+    }
+
+    return result;
+}
+
+// Is the capture good or equal? Most of them are,
+// based on simple piece values, otherwise we resort
+// to static exchange evaluation.
+bool CapturePicker::IsGood(Position* pos, const Move move) {
+
+    return IsGoodByValue(pos, move) || SeeGe(pos, move, 0);
+}
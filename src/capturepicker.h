@@ -0,0 +1,44 @@
+// Publius - Didactic public domain bitboard chess engine
+// by Pawel Koziol
+
+#pragma once
+
+// CapturePicker is a lean replacement of MovePicker for the late
+// quiescence search (modeCaptures), where we are not in check and
+// only good or equal captures are searched. Instead of generating
+// a move list, scoring and sorting it, CapturePicker maps enemy
+// pieces that we attack, then walks through them from the queen
+// down to the pawn, trying the attackers of each victim from the
+// pawn up to the king. So captures come out in MVV/LVA order
+// straight from the attack bitboards. Captures that lose material
+// according to static exchange evaluation are skipped. Promotions
+// (to a queen only) come last.
+
+enum CaptureStage {
+    captureTT,        // return move from transposition table
+    captureVictims,   // captures, most valuable victim first
+    capturePromotion, // queen promotions
+    captureEnd };     // no more moves
+
+class CapturePicker {
+private:
+    CaptureStage stage;
+    Move moveFromTT;
+    PieceType victimType;
+    PieceType hunterType;
+    Bitboard attacked; // enemy pieces we attack
+    Bitboard victims;  // remaining victims of victimType
+    Bitboard hunters;  // remaining pieces that can capture on toSquare
+    Bitboard promoters;
+    Bitboard promotionTargets;
+    Square toSquare;
+    Square fromSquare;
+    int flag;
+
+    Bitboard Attacked(Position* pos);
+    Bitboard Hunters(Position* pos, const CheckData* cd, const Square target);
+    bool IsGood(Position* pos, const Move move);
+public:
+    void Init(const Move ttMove);
+    Move NextMove(Position* pos);
+};
@@ -3,7 +3,13 @@
 
 // Collection of functions allowing to test the engine.
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
 #include <iostream> // for cout
+#include <memory>
+#include <vector>
 #include "types.h"
 #include "square.h" // for MirrorRank
 #include "limits.h"
@@ -13,8 +19,16 @@
 #include "publius.h" // for OnNewGame
 #include "move.h"
 #include "timer.h"
+#include "legality.h"
 #include "movepicker.h"
 #include "search.h"
+#include "pv.h"
+#include "nn.h"
+#include "evaldata.h"
+#include "eval.h"
+#include "badcapture.h"
+#include "searchstats.h"
+#include "profiler.h"
 
 std::string test[] = {
  "r1bqkbnr/pp1ppppp/2n5/2p5/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq -",           // 1.e4 c5 2.Nf3 Nc6
@@ -40,32 +54,236 @@ std::string test[] = {
 // Bench() function runs the analysis of several 
 // positions to the desired depth. It has two uses:
 // - confirming that a change is indeed non-functional
+//   (total node count serves as a signature)
 // - measuring how a change affects the engine's speed
+//   (with repeated runs, to see how noisy nps is)
+// Each position is searched from scratch (new game, fresh
+// search context), so its result does not depend on the
+// positions searched before. Positions come from the list
+// above or from a file with one FEN per line.
 
-void Bench(Position* pos, int depth) {
+struct BenchResult {
+    std::string fen;
+    int depth;
+    Bitboard nodes;
+    size_t time;
+    Move bestMove;
+};
+
+static bool LoadBenchPositions(const std::string& fileName, std::vector<std::string>& fens) {
+
+    std::ifstream file(fileName);
+    std::string line;
+
+    if (!file)
+        return false;
+
+    while (std::getline(file, line)) {
+
+        // Skip EPD operations and comments
+        line = line.substr(0, line.find_first_of(";#"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty())
+            fens.push_back(line);
+    }
+
+    return !fens.empty();
+}
 
-    SearchContext sc;
-    ClearSearchContext(sc);
+// Searches all the positions once, returns time used
+static size_t RunBench(Position* pos, const std::vector<std::string>& fens, int depth, std::vector<BenchResult>& results) {
+
+    results.clear();
+    Stats.Clear();
+#ifdef USE_SEARCH_STATS
+    blendCount = lazySkipCount = 0;
+    seeCallCount = 0;
+#endif
+
+#ifdef USE_PROFILER
+    ResetProfile();
+#endif
 
     Timer.Start();
     Timer.SetData(maxDepth, depth);
     Timer.SetData(moveTime, 3600000); // more than one hour of benchmark would be useless ;)
     Timer.SetData(isInfinite, 1);
 
-    for (size_t i = 0; i < std::size(test); ++i) {
+    for (const std::string& fen : fens) {
+
+        auto sc = std::make_unique<SearchContext>();
+        ClearSearchContext(*sc);
+
+        const Bitboard nodesBefore = Timer.nodeCount;
+        const size_t timeBefore = Timer.Elapsed();
 
-        std::cout << test[i] << "\n";
+        std::cout << fen << "\n";
         OnNewGame();
-        pos->Set(test[i]);
-        Iterate(pos, &sc);
+        Pv.Clear();
+        pos->Set(fen);
+        Iterate(pos, sc.get());
+
+        results.push_back({ fen, std::min(Timer.rootDepth, depth),
+                            Timer.nodeCount - nodesBefore,
+                            Timer.Elapsed() - timeBefore,
+                            Pv.GetBestMove() });
     }
 
+    Timer.SetData(isInfinite, 0);
     Timer.RefreshStats();
+    return Timer.timeUsed;
+}
+
+static void PrintBenchJson(int depth, int repeats, Bitboard signature, double meanNps, double stdDevNps,
+                           const std::vector<size_t>& runNps, const std::vector<BenchResult>& results) {
+
+    std::cout << "{\"depth\": " << depth
+              << ", \"threads\": 1"
+              << ", \"repeats\": " << repeats
+              << ", \"signature\": " << signature
+              << std::fixed << std::setprecision(0)
+              << ", \"nps\": {\"mean\": " << meanNps
+              << ", \"stddev\": " << stdDevNps
+              << ", \"runs\": [";
+
+    for (size_t i = 0; i < runNps.size(); i++)
+        std::cout << (i ? ", " : "") << runNps[i];
+
+    std::cout << "]}, \"positions\": [";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        std::cout << (i ? ", " : "")
+                  << "{\"fen\": \"" << result.fen
+                  << "\", \"depth\": " << result.depth
+                  << ", \"nodes\": " << result.nodes
+                  << ", \"time_ms\": " << result.time
+                  << ", \"best_move\": \"" << MoveToString(result.bestMove) << "\"}";
+    }
+
+    std::cout << "]";
+
+#ifdef USE_SEARCH_STATS
+    std::cout << ", \"searchstats\": ";
+    Stats.WriteJson(std::cout);
+#endif
+
+    std::cout << "}\n" << std::flush;
+}
+
+void Bench(Position* pos, int depth, int repeats, const std::string& fileName, int threads, bool asJson) {
+
+    std::vector<std::string> fens;
+    std::vector<BenchResult> results;
+    std::vector<size_t> runNps;
+    Bitboard signature = 0;
+    bool isStable = true;
+
+    if (fileName.empty())
+        fens.assign(std::begin(test), std::end(test));
+    else if (!LoadBenchPositions(fileName, fens)) {
+        std::cout << "info string cannot read positions from " << fileName << "\n" << std::flush;
+        return;
+    }
+
+    // Search runs in a single thread
+    if (threads != 1 && !asJson)
+        std::cout << "info string search is single-threaded, bench uses 1 thread\n";
+
+    repeats = std::max(repeats, 1);
+
+    // In JSON mode search output is discarded, 
+    // so that JSON is the only thing we print
+    std::streambuf* output = std::cout.rdbuf();
+
+    for (int run = 0; run < repeats; run++) {
+
+        if (asJson)
+            std::cout.rdbuf(nullptr);
 
-    std::cout << "Bench at depth " << depth
-              << " took " << Timer.timeUsed << " milliseconds, searching "
-              << Timer.nodeCount << " nodes at " << Timer.nps << " nodes per second.\n"
-              << std::flush;
+        const size_t timeUsed = RunBench(pos, fens, depth, results);
+        std::cout.rdbuf(output);
+
+        Bitboard nodes = 0;
+        for (const BenchResult& result : results)
+            nodes += result.nodes;
+
+        if (run > 0 && nodes != signature)
+            isStable = false;
+        signature = nodes;
+        runNps.push_back(timeUsed ? size_t(nodes * 1000 / timeUsed) : 0);
+
+        if (!asJson)
+            std::cout << "Bench at depth " << depth
+                      << " took " << timeUsed << " milliseconds, searching "
+                      << nodes << " nodes at " << runNps.back() << " nodes per second.\n"
+                      << std::flush;
+    }
+
+    // Mean and standard deviation of nodes per second
+    double meanNps = 0, stdDevNps = 0;
+
+    for (size_t nps : runNps)
+        meanNps += double(nps) / runNps.size();
+
+    for (size_t nps : runNps)
+        stdDevNps += (nps - meanNps) * (nps - meanNps) / runNps.size();
+
+    stdDevNps = std::sqrt(stdDevNps);
+
+    if (asJson) {
+        PrintBenchJson(depth, repeats, signature, meanNps, stdDevNps, runNps, results);
+        return;
+    }
+
+    std::cout << "\n" << std::left << std::setw(4) << "#"
+              << std::right << std::setw(7) << "depth"
+              << std::setw(12) << "nodes"
+              << std::setw(10) << "ms"
+              << std::setw(8) << "move" << "\n";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        std::cout << std::left << std::setw(4) << i + 1
+                  << std::right << std::setw(7) << results[i].depth
+                  << std::setw(12) << results[i].nodes
+                  << std::setw(10) << results[i].time
+                  << std::setw(8) << MoveToString(results[i].bestMove) << "\n";
+    }
+    std::cout << "\n";
+
+    if (repeats > 1)
+        std::cout << "Nodes per second over " << repeats << " runs: mean "
+                  << std::fixed << std::setprecision(0) << meanNps
+                  << ", standard deviation " << stdDevNps
+                  << std::setprecision(1) << " (" << (meanNps > 0 ? 100 * stdDevNps / meanNps : 0.0) << "%)\n";
+
+    if (!isStable)
+        std::cout << "info string node count differs between runs\n";
+
+#ifdef USE_SEARCH_STATS
+    if (blendCount)
+        std::cout << "Lazy blend skipped HCE in " << lazySkipCount
+                  << " of " << blendCount << " evaluations ("
+                  << lazySkipCount * 100 / blendCount << "%)\n" << std::flush;
+
+    if (Timer.nodeCount)
+        std::cout << "Static exchange evaluator called " << seeCallCount
+                  << " times (" << std::defaultfloat << std::setprecision(6) << double(seeCallCount) / Timer.nodeCount
+                  << " per node)\n" << std::flush;
+
+    Stats.Print(false);
+#endif
+
+#ifdef USE_PROFILER
+    PrintProfile();
+#endif
+
+#ifdef VERIFY_NNUE
+    PrintVerificationCost(Timer.timeUsed);
+#endif
+
+    // Signature line in the format expected by testing frameworks
+    std::cout << signature << " nodes " << size_t(meanNps) << " nps\n" << std::flush;
 }
 
 // print board
@@ -93,45 +311,6 @@ void PrintBoard(Position* pos) {
     std::cout << "--------------------------------------------\n" << std::flush;
 }
 
-// Perft can be used to measure move generation 
-// and board update speed, but more importantly, 
-// to confirm that the move generator works correctly. 
-// This version comes with a "divide" enhancement,
-// printing out subtotals for each move.
-Bitboard Perft(Position* pos, int ply, int depth, bool isNoisy) {
-
-    Move move = 0;
-    Bitboard localCount = 0;
-    Bitboard moveCount = 0;
-    UndoData undo;
-    MovePicker movePicker;
-
-    movePicker.Init(modeAll, 0, 0, 0, 0);
-
-    while ((move = movePicker.NextMove(pos)) != 0) {
-
-        pos->DoMove(move, &undo);
-
-        if (pos->IsOwnKingInCheck()) {
-            pos->UndoMove(move, &undo);
-            continue;
-        }
-
-        localCount = (depth == 1) 
-                   ? 1 
-                   : Perft(pos, ply + 1, depth - 1, isNoisy);
-
-        moveCount += localCount;
-
-        pos->UndoMove(move, &undo);
-
-        if (ply == 0 && isNoisy)
-            std::cout << MoveToString(move) << ": " << localCount << "\n";
-    }
-    
-    return moveCount;
-}
-
 // Print a bitboard (useful debugging tool)
 void PrintBitboard(Bitboard b) {
    
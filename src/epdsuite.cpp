@@ -0,0 +1,321 @@
+// Publius - Didactic public domain bitboard chess engine
+// by Pawel Koziol
+
+// Test suite runner. Reads EPD files with "bm" (best move)
+// and "am" (avoid move) operations, searches each position
+// under a time, node or depth budget and reports how many
+// positions were solved, how soon the solution was found
+// and how long it took to reach each depth. This measures
+// search improvements end to end, not just speed.
+//
+// Time to solution is the time of the first completed
+// iteration from which the engine kept choosing a correct
+// move until the end of the search. If the correct move
+// was found during the unfinished last iteration, the whole
+// search time counts.
+//
+// Search uses global state (timer, transposition table,
+// history), so positions are searched one after another.
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include "types.h"
+#include "square.h"
+#include "limits.h"
+#include "position.h"
+#include "movelist.h"
+#include "move.h"
+#include "gen.h"
+#include "timer.h"
+#include "pv.h"
+#include "search.h"
+#include "publius.h"
+
+struct EpdTest {
+    std::string fen;
+    std::string id;
+    std::vector<std::string> bestMoves;  // "bm" operands
+    std::vector<std::string> avoidMoves; // "am" operands
+};
+
+enum EpdBudget { budgetTime, budgetNodes, budgetDepth };
+
+// Move in standard algebraic notation, without check marks
+static std::string MoveToSan(Position* pos, const Move move, MoveList* legalMoves) {
+
+    const Square fromSquare = GetFromSquare(move);
+    const Square toSquare = GetToSquare(move);
+    const PieceType hunter = pos->PieceTypeOnSq(fromSquare);
+    const bool isCapture = pos->IsOccupied(toSquare) || GetTypeOfMove(move) == tEnPassant;
+    const std::string target = MoveToString(move).substr(2, 2);
+    std::string san;
+
+    if (GetTypeOfMove(move) == tCastle)
+        return FileOf(toSquare) == 6 ? "O-O" : "O-O-O";
+
+    if (hunter == Pawn) {
+        if (isCapture)
+            san += char('a' + FileOf(fromSquare));
+    }
+    else {
+        san += "PNBRQK"[hunter];
+
+        // Disambiguate between pieces of the same kind
+        bool isAmbiguous = false, isSameFile = false, isSameRank = false;
+        for (int i = 0; i < legalMoves->GetLength(); i++) {
+            const Move other = legalMoves->GetNextRawMove();
+            const Square otherSquare = GetFromSquare(other);
+            if (GetToSquare(other) == toSquare && otherSquare != fromSquare &&
+                pos->PieceTypeOnSq(otherSquare) == hunter) {
+                isAmbiguous = true;
+                isSameFile |= IsSameFile(otherSquare, fromSquare);
+                isSameRank |= IsSameRank(otherSquare, fromSquare);
+            }
+        }
+
+        if (isAmbiguous) {
+            if (!isSameFile)
+                san += char('a' + FileOf(fromSquare));
+            else if (!isSameRank)
+                san += char('1' + RankOf(fromSquare));
+            else
+                san += MoveToString(move).substr(0, 2);
+        }
+    }
+
+    if (isCapture)
+        san += "x";
+
+    san += target;
+
+    if (IsMovePromotion(move))
+        san += std::string("=") + "PNBRQK"[GetPromotedPiece(move)];
+
+    return san;
+}
+
+// Drop decorations, so that "Qxf6+", "Qxf6" and "Qf6" compare equal
+static std::string NormalizeSan(const std::string& san) {
+
+    std::string result;
+
+    for (char c : san) {
+        if (c == '0')
+            c = 'O';
+        if (std::string("x=+#!?").find(c) == std::string::npos)
+            result += c;
+    }
+    return result;
+}
+
+// Does the move match any of the moves from EPD (in SAN or coordinates)?
+static bool IsMoveOnList(Position* pos, const Move move, const std::vector<std::string>& moves) {
+
+    MoveList list;
+    list.Clear();
+    FillNoisyList(pos, &list, pos->GetCheckData());
+    FillQuietList(pos, &list, pos->GetCheckData());
+
+    const std::string san = NormalizeSan(MoveToSan(pos, move, &list));
+    const std::string coordinates = MoveToString(move);
+
+    for (const std::string& candidate : moves)
+        if (NormalizeSan(candidate) == san || candidate == coordinates)
+            return true;
+
+    return false;
+}
+
+static bool IsSolution(Position* pos, const EpdTest& test, const Move move) {
+
+    if (!move)
+        return false;
+
+    if (!test.bestMoves.empty() && !IsMoveOnList(pos, move, test.bestMoves))
+        return false;
+
+    return !IsMoveOnList(pos, move, test.avoidMoves);
+}
+
+// "fen; bm Qf6; id "name";" - the first four fields
+// (plus move counters if present) make the position
+static bool ParseEpdLine(const std::string& line, EpdTest* test) {
+
+    std::istringstream stream(line);
+    std::string token, operations;
+
+    for (int i = 0; i < 4; i++) {
+        if (!(stream >> token))
+            return false;
+        test->fen += (i ? " " : "") + token;
+    }
+
+    std::getline(stream, operations);
+    std::istringstream opStream(operations);
+    std::string operation;
+
+    while (std::getline(opStream, operation, ';')) {
+
+        std::istringstream words(operation);
+        std::string opcode, operand;
+        words >> opcode;
+
+        if (opcode == "id") {
+            std::getline(words, operand);
+            operand.erase(0, operand.find_first_not_of(" \""));
+            operand.erase(operand.find_last_not_of(" \"") + 1);
+            test->id = operand;
+        }
+        else if (opcode == "bm" || opcode == "am") {
+            while (words >> operand)
+                (opcode == "bm" ? test->bestMoves : test->avoidMoves).push_back(operand);
+        }
+        else if (!opcode.empty() && std::all_of(opcode.begin(), opcode.end(), ::isdigit)) {
+            // halfmove clock and move number
+            test->fen += " " + opcode;
+            if (words >> operand)
+                test->fen += " " + operand;
+        }
+    }
+
+    return !test->bestMoves.empty() || !test->avoidMoves.empty();
+}
+
+static double Percentile(std::vector<size_t> values, double fraction) {
+
+    if (values.empty())
+        return 0;
+
+    std::sort(values.begin(), values.end());
+    return double(values[size_t(fraction * (values.size() - 1))]);
+}
+
+static double Mean(const std::vector<size_t>& values) {
+
+    double sum = 0;
+    for (size_t value : values)
+        sum += double(value);
+    return values.empty() ? 0 : sum / values.size();
+}
+
+static void SetBudget(Position* pos, EpdBudget budget, size_t limit) {
+
+    Timer.Clear();
+
+    if (budget == budgetTime)
+        Timer.SetData(moveTime, limit);
+    else {
+        Timer.SetData(moveTime, INT_MAX);
+        Timer.SetData(budget == budgetNodes ? maxNodes : maxDepth, limit);
+    }
+
+    Timer.SetDataForColor(pos->GetSideToMove());
+    Timer.SetMoveTiming();
+}
+
+void EpdSuite(Position* pos, const std::string& fileName, const std::string& budgetName, size_t limit) {
+
+    std::ifstream file(fileName);
+    std::vector<EpdTest> tests;
+    std::string line;
+
+    if (!file) {
+        std::cout << "info string cannot open " << fileName << "\n" << std::flush;
+        return;
+    }
+
+    while (std::getline(file, line)) {
+        EpdTest test;
+        if (ParseEpdLine(line, &test))
+            tests.push_back(test);
+    }
+
+    const EpdBudget budget = budgetName == "nodes" ? budgetNodes
+                           : budgetName == "depth" ? budgetDepth : budgetTime;
+
+    std::vector<size_t> solutionTimes;
+    std::vector<std::vector<size_t>> depthTimes(SearchTreeSize);
+    std::vector<IterationInfo> iterations;
+    std::streambuf* output = std::cout.rdbuf();
+    size_t solved = 0;
+
+    for (size_t i = 0; i < tests.size(); i++) {
+
+        const EpdTest& test = tests[i];
+
+        OnNewGame();
+        pos->Set(test.fen);
+        SetBudget(pos, budget, limit);
+        iterations.clear();
+
+        // Search quietly, remembering completed iterations
+        std::cout.rdbuf(nullptr);
+        iterationRecorder = &iterations;
+        Think(pos);
+        iterationRecorder = nullptr;
+        std::cout.rdbuf(output);
+
+        const Move bestMove = Pv.GetBestMove();
+        const size_t timeUsed = Timer.Elapsed();
+        const bool isSolved = IsSolution(pos, test, bestMove);
+
+        for (const IterationInfo& iteration : iterations)
+            if (iteration.depth < SearchTreeSize)
+                depthTimes[iteration.depth].push_back(iteration.time);
+
+        // Go back through completed iterations for as long
+        // as they agree with the final (correct) choice
+        size_t solutionTime = timeUsed;
+        if (isSolved) {
+            for (auto it = iterations.rbegin(); it != iterations.rend(); ++it) {
+                if (!IsSolution(pos, test, it->bestMove))
+                    break;
+                solutionTime = it->time;
+            }
+            solutionTimes.push_back(solutionTime);
+            solved++;
+        }
+
+        std::cout << std::setw(4) << i + 1 << " "
+                  << std::left << std::setw(20) << (test.id.empty() ? "-" : test.id.substr(0, 20))
+                  << std::right << std::setw(7) << MoveToString(bestMove)
+                  << (isSolved ? "  solved in " : "  failed   ")
+                  << std::setw(7) << (isSolved ? solutionTime : timeUsed) << " ms, depth "
+                  << (iterations.empty() ? 0 : iterations.back().depth) << "\n" << std::flush;
+    }
+
+    std::cout << "\nSolved " << solved << " of " << tests.size() << " positions";
+    if (!tests.empty())
+        std::cout << " (" << solved * 100 / tests.size() << "%)";
+    std::cout << "\n";
+
+    if (!solutionTimes.empty())
+        std::cout << "Time to solution: mean " << std::fixed << std::setprecision(0)
+                  << Mean(solutionTimes) << " ms, median " << Percentile(solutionTimes, 0.5)
+                  << " ms, 90th percentile " << Percentile(solutionTimes, 0.9)
+                  << " ms, max " << Percentile(solutionTimes, 1.0) << " ms\n";
+
+    std::cout << "\nTime to depth:\n"
+              << std::setw(6) << "depth" << std::setw(11) << "positions"
+              << std::setw(12) << "mean ms" << std::setw(12) << "median ms"
+              << std::setw(12) << "90% ms" << "\n";
+
+    for (int depth = 1; depth < SearchTreeSize; depth++) {
+        if (depthTimes[depth].empty())
+            continue;
+        std::cout << std::setw(6) << depth
+                  << std::setw(11) << depthTimes[depth].size()
+                  << std::fixed << std::setprecision(0)
+                  << std::setw(12) << Mean(depthTimes[depth])
+                  << std::setw(12) << Percentile(depthTimes[depth], 0.5)
+                  << std::setw(12) << Percentile(depthTimes[depth], 0.9) << "\n";
+    }
+    std::cout << std::flush;
+}
@@ -43,6 +43,7 @@
 #include "mask.h"
 #include "nn.h"
 #include "publius.h" // for hasNNUE
+#include "profiler.h"
 
 // "Fake" king location, used to initialize
 // king attack zone. This has two benefits:
@@ -73,10 +74,27 @@ Bitboard trappedRookQs[2] = { Paint(B1, A1, A2), Paint(B8, A8, A7) };
 Bitboard trappingKingKs[2] = { Paint(F1, G1), Paint(F8, G8) };
 Bitboard trappingKingQs[2] = { Paint(C1, B1), Paint(C8, B8) };
 
-int Evaluate(Position* pos, EvalData* e) {
+// Lazy blend: if NNUE score is decisive or this far
+// outside the search window, we skip the HCE
+const int lazyMargin = 400;
+const int decisiveScore = 1200;
+
+#ifdef USE_SEARCH_STATS
+size_t blendCount;
+size_t lazySkipCount;
+#endif
+
+int Evaluate(Position* pos, EvalData* e, int alpha, int beta) {
+
+    PROFILE_SCOPE(profEvaluate);
 
     int score = 0;
 
+#ifdef VERIFY_NNUE
+    if (isNNUEloaded)
+        VerifyAccumulator(*pos);
+#endif
+
 #ifndef USE_TUNING
     // Try to retrieve the score from the evaluation hashtable
     // (which contains scores from stm perspective, so no
@@ -87,11 +105,7 @@ int Evaluate(Position* pos, EvalData* e) {
 
 #ifndef HCE_ONLY
     if (isNNUEloaded) {
-        score = 0;
-        if (nnueWeight > 0)
-            score += EvalNN(pos) * nnueWeight / 100;
-        if (hceWeight > 0)
-            score += EvalHCE(pos, e) * hceWeight / 100;
+        score = EvalBlend(pos, e, alpha, beta);
     }
     else 
 #endif
@@ -108,8 +122,44 @@ int Evaluate(Position* pos, EvalData* e) {
     return score;
 }
 
+// Weighted sum of NNUE and handcrafted eval. NNUE is cheaper,
+// since its accumulator is updated incrementally, so it goes
+// first. If its score is decisive or far outside the search 
+// window, we assume that the HCE would not change the verdict,
+// skip it and scale NNUE score to the full weight.
+int EvalBlend(Position* pos, EvalData* e, int alpha, int beta) {
+
+    // Only one component is used, nothing to be lazy about
+    if (hceWeight == 0)
+        return (nnueWeight > 0) ? EvalNN(pos) * nnueWeight / 100 : 0;
+
+    if (nnueWeight == 0)
+        return EvalHCE(pos, e) * hceWeight / 100;
+
+#ifdef USE_SEARCH_STATS
+    blendCount++;
+#endif
+
+    const int nnScore = EvalNN(pos);
+    const int estimate = nnScore * (nnueWeight + hceWeight) / 100;
+
+    if (std::abs(nnScore) > decisiveScore ||
+        estimate - lazyMargin >= beta ||
+        estimate + lazyMargin <= alpha) {
+#ifdef USE_SEARCH_STATS
+        lazySkipCount++;
+#endif
+        return estimate;
+    }
+
+    return nnScore * nnueWeight / 100 
+         + EvalHCE(pos, e) * hceWeight / 100;
+}
+
 int EvalNN(Position* pos) {
 
+    PROFILE_SCOPE(profEvalNN);
+
     // Get score from the neural network
     int score = NN.GetScore(pos->GetSideToMove());
 
@@ -119,6 +169,8 @@ int EvalNN(Position* pos) {
 // Hand-crafted evaluation function
 int EvalHCE(Position* pos, EvalData* e) {
 
+    PROFILE_SCOPE(profEvalHCE);
+
     int score = 0;
 
     // Init eval data
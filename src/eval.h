@@ -18,6 +18,7 @@ public:
     void Clear();
     void Save(Bitboard key, int val);
     bool Retrieve(Bitboard key, int* score) const;
+    void Delete(Bitboard key); // used by evalbench to force a miss
 
 private:
     size_t Address(Bitboard key) const;
@@ -29,9 +30,14 @@ extern EvalHashTable EvalHash; // full evaluation hashtable
 extern EvalHashTable PawnHash; // pawn structure eval hashtable
 
 // Main evaluation functions
+int EvalBlend(Position* pos, EvalData* e, int alpha, int beta);
 int EvalNN(Position* pos);
 int EvalHCE(Position* pos, EvalData* e);
 
+// Lazy blend statistics (with USE_SEARCH_STATS, reported by bench)
+extern size_t blendCount;
+extern size_t lazySkipCount;
+
 // Handcrafted evaluation helpers
 void EvalBasic(EvalData* e, const Color color, const PieceType piece, const int sq);
 void EvalPawnStructure(const Position* pos, EvalData* e);
@@ -0,0 +1,244 @@
+// Publius - Didactic public domain bitboard chess engine
+// by Pawel Koziol
+
+// Evaluation micro-benchmark. Inside a search, a small change
+// in evaluation speed is lost in the noise, so EvalBench()
+// calls Evaluate() directly on positions read from a file,
+// with handcrafted eval only (with and without the pawn hash),
+// NNUE only and both blended. It also compares the cost of
+// a full NNUE accumulator refresh with incremental updates
+// done by DoMove() and UndoMove().
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "types.h"
+#include "limits.h"
+#include "position.h"
+#include "movelist.h"
+#include "gen.h"
+#include "evaldata.h"
+#include "eval.h"
+#include "api.h"
+#include "nn.h"
+#include "publius.h"
+
+// Evaluate() calls per position in each timed batch
+constexpr int evalBatch = 64;
+
+// Make and unmake passes over the legal moves of a position
+constexpr int movePasses = 16;
+
+enum EvalBenchMode { benchHce, benchHceNoPawnHash, benchNnue, benchBlend, evalBenchModeCount };
+
+static const char* modeNames[evalBenchModeCount] = {
+    "HCE", "HCE, no pawn hash", "NNUE", "blend" };
+
+// Time a block of code, returning nanoseconds
+template <typename Code>
+static double Nanoseconds(Code code) {
+
+    using namespace std::chrono;
+    auto start = steady_clock::now();
+    code();
+    return double(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+}
+
+// EPD or FEN lines: the first four fields make the position
+static bool LoadEvalPositions(const std::string& fileName, std::vector<std::string>& fens) {
+
+    std::ifstream file(fileName);
+    std::string line;
+
+    if (!file)
+        return false;
+
+    while (std::getline(file, line)) {
+
+        std::istringstream stream(line);
+        std::string token, fen;
+
+        for (int i = 0; i < 4 && stream >> token; i++)
+            fen += (i ? " " : "") + token;
+
+        if (std::count(fen.begin(), fen.end(), ' ') == 3)
+            fens.push_back(fen);
+    }
+
+    return !fens.empty();
+}
+
+static void SetEvalMode(EvalBenchMode mode, int blendNnueWeight, int blendHceWeight) {
+
+    isNNUEloaded = (mode == benchNnue || mode == benchBlend);
+    nnueWeight = (mode == benchBlend) ? blendNnueWeight : 100;
+    hceWeight = (mode == benchBlend) ? blendHceWeight : 100;
+
+    if (mode == benchNnue)
+        hceWeight = 0;
+}
+
+// Nanoseconds per Evaluate() call
+static double TimeEvaluation(Position* pos, const std::vector<std::string>& fens, EvalBenchMode mode) {
+
+    EvalData e;
+    volatile int sink = 0;
+    double ns = 0;
+
+    for (const std::string& fen : fens) {
+
+        pos->Set(fen);
+
+        ns += Nanoseconds([&] {
+            for (int i = 0; i < evalBatch; i++) {
+
+                // Forget the pawn structure, so that
+                // each evaluation has to score it again
+                if (mode == benchHceNoPawnHash)
+                    PawnHash.Delete(pos->pawnKingHash);
+
+                sink = sink + Evaluate(pos, &e, -Infinity, Infinity);
+            }
+        });
+    }
+
+    return ns / (double(fens.size()) * evalBatch);
+}
+
+// Nanoseconds per NNUE accumulator refresh
+static double TimeRefresh(Position* pos, const std::vector<std::string>& fens) {
+
+    double ns = 0;
+
+    for (const std::string& fen : fens) {
+        pos->Set(fen);
+        ns += Nanoseconds([&] {
+            for (int i = 0; i < evalBatch; i++)
+                NN.Refresh(*pos);
+        });
+    }
+
+    return ns / (double(fens.size()) * evalBatch);
+}
+
+// Nanoseconds per DoMove() and UndoMove() pair
+static double TimeMakeUnmake(Position* pos, const std::vector<std::string>& fens) {
+
+    MoveList list;
+    UndoData undo;
+    Move move;
+    double ns = 0;
+    size_t moveCount = 0;
+
+    for (const std::string& fen : fens) {
+
+        pos->Set(fen);
+        list.Clear();
+        FillNoisyList(pos, &list, pos->GetCheckData());
+        FillQuietList(pos, &list, pos->GetCheckData());
+
+        std::vector<Move> moves;
+        while ((move = list.GetNextRawMove()) != 0)
+            moves.push_back(move);
+
+        ns += Nanoseconds([&] {
+            for (int pass = 0; pass < movePasses; pass++) {
+                for (Move m : moves) {
+                    pos->DoMove(m, &undo);
+                    pos->UndoMove(m, &undo);
+                }
+            }
+        });
+        moveCount += moves.size() * movePasses;
+    }
+
+    return moveCount ? ns / moveCount : 0;
+}
+
+static void PrintEvalSpeed(const char* name, double ns) {
+
+    std::cout << std::left << std::setw(20) << name
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << ns
+              << std::setw(14) << (ns > 0 ? 1000.0 / ns : 0.0) << "\n";
+}
+
+void EvalBench(Position* pos, const std::string& fileName) {
+
+    // Test positions are set up on a scratch board,
+    // so the position of the game stays untouched
+    Position board[1];
+    std::vector<std::string> fens;
+
+    if (!LoadEvalPositions(fileName, fens)) {
+        std::cout << "info string cannot read positions from " << fileName << "\n" << std::flush;
+        return;
+    }
+
+    const bool wasLoaded = isNNUEloaded;
+    const int oldNnueWeight = nnueWeight;
+    const int oldHceWeight = hceWeight;
+
+    // Blend with the current weights, unless one of them
+    // switches a component off; then use an even mix
+    const bool isBlending = (nnueWeight > 0 && hceWeight > 0);
+    const int blendNnueWeight = isBlending ? nnueWeight : 50;
+    const int blendHceWeight = isBlending ? hceWeight : 50;
+
+    std::cout << fens.size() << " positions, " << evalBatch << " evaluations each\n\n"
+              << std::left << std::setw(20) << "mode"
+              << std::right << std::setw(12) << "ns/eval"
+              << std::setw(14) << "Mevals/s" << "\n";
+
+    for (int mode = benchHce; mode < evalBenchModeCount; mode++) {
+
+        if (!wasLoaded && (mode == benchNnue || mode == benchBlend))
+            continue;
+
+        SetEvalMode((EvalBenchMode)mode, blendNnueWeight, blendHceWeight);
+        TimeEvaluation(board, fens, (EvalBenchMode)mode); // warm up
+        PrintEvalSpeed(modeNames[mode], TimeEvaluation(board, fens, (EvalBenchMode)mode));
+    }
+
+    if (wasLoaded) {
+
+        std::cout << "(blend uses nnueWeight " << blendNnueWeight
+                  << " and hceWeight " << blendHceWeight << ", full window)\n\n";
+
+        // Without NNUE, DoMove() and UndoMove() skip accumulator
+        // updates, so the difference is the cost of the updates
+        isNNUEloaded = false;
+        TimeMakeUnmake(board, fens);
+        const double plainNs = TimeMakeUnmake(board, fens);
+        isNNUEloaded = true;
+        const double nnueNs = TimeMakeUnmake(board, fens);
+        const double updateNs = std::max(nnueNs - plainNs, 0.0);
+        const double refreshNs = TimeRefresh(board, fens);
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Accumulator refresh        " << std::setw(10) << refreshNs << " ns\n"
+                  << "Do/undo move with NNUE     " << std::setw(10) << nnueNs << " ns\n"
+                  << "Do/undo move without NNUE  " << std::setw(10) << plainNs << " ns\n"
+                  << "Incremental updates        " << std::setw(10) << updateNs << " ns per move made and unmade\n";
+
+        if (updateNs > 0)
+            std::cout << "One refresh costs as much as " << refreshNs / updateNs
+                      << " moves made and unmade\n";
+    }
+    else
+        std::cout << "\nNNUE is not loaded, so only handcrafted eval was timed\n";
+
+    std::cout << std::flush;
+
+    // Restore settings and the accumulator of the game position
+    isNNUEloaded = wasLoaded;
+    nnueWeight = oldNnueWeight;
+    hceWeight = oldHceWeight;
+    if (isNNUEloaded)
+        NN.Refresh(*pos);
+}
@@ -43,6 +43,15 @@ bool EvalHashTable::Retrieve(Bitboard key, int* score) const {
     return false;
 }
 
+// remove position evaluation, if present
+void EvalHashTable::Delete(Bitboard key) {
+
+    size_t addr = Address(key);
+
+    if (EvalTT[addr].key == key)
+        EvalTT[addr].key = ~key;
+}
+
 // where to save/look for data?
 size_t EvalHashTable::Address(Bitboard key) const {
     return key & (tableSize - 1); // Bitwise AND operation
@@ -2,7 +2,12 @@
 // by Pawel Koziol
 
 // Functions filling the move list with different
-// categories of moves
+// categories of moves. All of them emit legal moves
+// only: CheckData (see legality.h) restricts pinned
+// pieces to their pin lines and, when we are in check,
+// limits moves of other pieces to capturing the checker
+// or blocking the check. King moves and en passant
+// captures are tested individually.
 
 #include "types.h"
 #include "position.h"
@@ -13,11 +18,25 @@
 #include "move.h"
 #include "legality.h"
 #include "gen.h"
+#include "publius.h"
+#include "profiler.h"
+
+// Squares to which a piece standing on fromSquare
+// may legally move (king is handled separately)
+static inline Bitboard LegalTargets(const CheckData* cd, const Square fromSquare) {
+
+    if (cd->pinned & Paint(fromSquare))
+        return cd->checkMask & Mask.line[cd->kingSq][fromSquare];
+
+    return cd->checkMask;
+}
 
 // Fill move list with moves that change material balance:
 // captures, including en passant, and promotions
 
-void FillNoisyList(Position* pos, MoveList* list) {
+void FillNoisyList(Position* pos, MoveList* list, const CheckData* cd) {
+
+    PROFILE_SCOPE(profNoisyGen);
 
     Bitboard pieces, moves;
     Square fromSquare, toSquare;
@@ -25,38 +44,39 @@ void FillNoisyList(Position* pos, MoveList* list) {
     const Bitboard prey = pos->Pieces(~color);
     const Bitboard occ = pos->Occupied();
     const Bitboard empty = ~occ;
+    const Bitboard target = cd->checkMask; // empty in double check
 
     if (color == White) {
 
         // White pawn promotions with capture (NW)
         pieces = pos->Map(White, Pawn) & Mask.rank[rank7];
-        moves = NWOf(pieces) & prey;
-        SerializePromotions(list, moves, -7);
+        moves = NWOf(pieces) & prey & target;
+        SerializePromotions(list, moves, -7, cd);
 
         // White pawn promotions with capture (NE)
-        moves = NEOf(pieces) & prey;
-        SerializePromotions(list, moves, -9);
+        moves = NEOf(pieces) & prey & target;
+        SerializePromotions(list, moves, -9, cd);
 
         // White pawn promotions without capture
-        moves = NorthOf(pieces) & empty;
-        SerializePromotions(list, moves, -8);
+        moves = NorthOf(pieces) & empty & target;
+        SerializePromotions(list, moves, -8, cd);
 
         // Map white pawns that cannot promote
         pieces = pos->Map(White, Pawn) & ~Mask.rank[rank7];
 
         // White pawn captures (NW)
-        moves = NWOf(pieces) & prey;
-        SerializePawnMoves(list, moves, -7, tNormal);
+        moves = NWOf(pieces) & prey & target;
+        SerializePawnMoves(list, moves, -7, tNormal, cd);
 
         // White pawn captures (NE)
-        moves = NEOf(pieces) & prey;
-        SerializePawnMoves(list, moves, -9, tNormal);
+        moves = NEOf(pieces) & prey & target;
+        SerializePawnMoves(list, moves, -9, tNormal, cd);
 
         // White en passant capture
         if ((toSquare = pos->EnPassantSq() ) != sqNone) {
-            if (NWOf(pieces) & Paint(toSquare))
+            if ((NWOf(pieces) & Paint(toSquare)) && IsEnPassantLegal(pos, toSquare - 7, toSquare))
                 list->AddMove(toSquare - 7, toSquare, tEnPassant);
-            if (NEOf(pieces) & Paint(toSquare))
+            if ((NEOf(pieces) & Paint(toSquare)) && IsEnPassantLegal(pos, toSquare - 9, toSquare))
                 list->AddMove(toSquare - 9, toSquare, tEnPassant);
         }
     } else {
@@ -64,42 +84,42 @@ void FillNoisyList(Position* pos, MoveList* list) {
         pieces = pos->Map(Black, Pawn) & Mask.rank[rank2]; // black pawns that can promote
 
         // Black pawn promotions with capture (SW)
-        moves = SWOf(pieces) & prey;
-        SerializePromotions(list, moves, 9);
+        moves = SWOf(pieces) & prey & target;
+        SerializePromotions(list, moves, 9, cd);
 
         // Black pawn promotions with capture (SE)
-        moves = SEOf(pieces) & prey;
-        SerializePromotions(list, moves, 7);
+        moves = SEOf(pieces) & prey & target;
+        SerializePromotions(list, moves, 7, cd);
 
         // Black pawn promotions without capture
-        moves = SouthOf(pieces) & empty;
-        SerializePromotions(list, moves, 8);
+        moves = SouthOf(pieces) & empty & target;
+        SerializePromotions(list, moves, 8, cd);
 
         // Map black pawns that cannot promote
         pieces = pos->Map(Black, Pawn) & ~Mask.rank[rank2];
 
         // Black pawn captures, excluding promotions (SW)
-        moves = SWOf(pieces) & prey;
-        SerializePawnMoves(list, moves, 9, tNormal);
+        moves = SWOf(pieces) & prey & target;
+        SerializePawnMoves(list, moves, 9, tNormal, cd);
 
         // Black pawn captures, excluding promotions (SE)
-        moves = SEOf(pieces) & prey;
-        SerializePawnMoves(list, moves, 7, tNormal);
+        moves = SEOf(pieces) & prey & target;
+        SerializePawnMoves(list, moves, 7, tNormal, cd);
 
         // Black en passant capture
         if ((toSquare = pos->EnPassantSq() ) != sqNone) {
-            if (SWOf(pieces) & Paint(toSquare))
+            if ((SWOf(pieces) & Paint(toSquare)) && IsEnPassantLegal(pos, toSquare + 9, toSquare))
                 list->AddMove(toSquare + 9, toSquare, tEnPassant);
-            if (SEOf(pieces) & Paint(toSquare))
+            if ((SEOf(pieces) & Paint(toSquare)) && IsEnPassantLegal(pos, toSquare + 7, toSquare))
                 list->AddMove(toSquare + 7, toSquare, tEnPassant);
         }
     }
 
-    // Captures by knight
-    pieces = pos->Map(color, Knight);
+    // Captures by knight (pinned knight cannot move at all)
+    pieces = pos->Map(color, Knight) & ~cd->pinned;
     while (pieces) {
         fromSquare = PopFirstBit(&pieces);
-        moves = GenerateMoves.Knight(fromSquare) & prey;
+        moves = GenerateMoves.Knight(fromSquare) & prey & target;
         SerializeMoves(list, fromSquare, moves);
     }
 
@@ -107,7 +127,7 @@ void FillNoisyList(Position* pos, MoveList* list) {
     pieces = pos->MapDiagonalSliders(color);
     while (pieces) {
         fromSquare = PopFirstBit(&pieces);
-        moves = GenerateMoves.Bish(occ, fromSquare) & prey;
+        moves = GenerateMoves.Bish(occ, fromSquare) & prey & LegalTargets(cd, fromSquare);
         SerializeMoves(list, fromSquare, moves);
     }
 
@@ -115,16 +135,18 @@ void FillNoisyList(Position* pos, MoveList* list) {
     pieces = pos->MapStraightSliders(color);
     while (pieces) {
         fromSquare = PopFirstBit(&pieces);
-        moves = GenerateMoves.Rook(occ, fromSquare) & prey;
+        moves = GenerateMoves.Rook(occ, fromSquare) & prey & LegalTargets(cd, fromSquare);
         SerializeMoves(list, fromSquare, moves);
     }
 
     // Captures by king
-    moves = GenerateMoves.King(pos->KingSq(color)) & prey;
-    SerializeMoves(list, pos->KingSq(color), moves);
+    moves = GenerateMoves.King(cd->kingSq) & prey;
+    SerializeKingMoves(pos, list, cd->kingSq, moves);
 }
 
-void FillQuietList(Position* pos, MoveList* list) {
+void FillQuietList(Position* pos, MoveList* list, const CheckData* cd) {
+
+    PROFILE_SCOPE(profQuietGen);
 
     Bitboard pieces, moves, firstStep;
     Square fromSquare;
@@ -132,6 +154,7 @@ void FillQuietList(Position* pos, MoveList* list) {
     const Bitboard occ = pos->Occupied();
     const Bitboard empty = ~occ;
     const Bitboard pawns = pos->Map(color, Pawn);
+    const Bitboard target = cd->checkMask; // empty in double check
 
     if (color == White) {
 
@@ -145,12 +168,12 @@ void FillQuietList(Position* pos, MoveList* list) {
 
         // White double pawn moves
         firstStep = NorthOf(pawns & Mask.rank[rank2]) & empty;
-        moves = NorthOf(firstStep) & empty;
-        SerializePawnMoves(list, moves, -16, tPawnjump);
+        moves = NorthOf(firstStep) & empty & target;
+        SerializePawnMoves(list, moves, -16, tPawnjump, cd);
 
         // White normal pawn moves
-        moves = NorthOf(pawns & ~Mask.rank[rank7]) & empty;
-        SerializePawnMoves(list, moves, -8, tNormal);
+        moves = NorthOf(pawns & ~Mask.rank[rank7]) & empty & target;
+        SerializePawnMoves(list, moves, -8, tNormal, cd);
 
     } else {
  
@@ -164,19 +187,19 @@ void FillQuietList(Position* pos, MoveList* list) {
         
         // Black double pawn moves
         firstStep = SouthOf(pawns & Mask.rank[rank7]) & empty;
-        moves = SouthOf(firstStep) & empty;
-        SerializePawnMoves(list, moves, 16, tPawnjump);
+        moves = SouthOf(firstStep) & empty & target;
+        SerializePawnMoves(list, moves, 16, tPawnjump, cd);
 
         // Black single pawn moves
-        moves = SouthOf(pawns & ~Mask.rank[rank2]) & empty;
-        SerializePawnMoves(list, moves, 8, tNormal);
+        moves = SouthOf(pawns & ~Mask.rank[rank2]) & empty & target;
+        SerializePawnMoves(list, moves, 8, tNormal, cd);
     }
 
-    // Knight moves
-    pieces = pos->Map(color, Knight);
+    // Knight moves (pinned knight cannot move at all)
+    pieces = pos->Map(color, Knight) & ~cd->pinned;
     while (pieces) {
         fromSquare = PopFirstBit(&pieces);
-        moves = GenerateMoves.Knight(fromSquare) & empty;
+        moves = GenerateMoves.Knight(fromSquare) & empty & target;
         SerializeMoves(list, fromSquare, moves);
     }
 
@@ -184,7 +207,7 @@ void FillQuietList(Position* pos, MoveList* list) {
     pieces = pos->Map(color, Bishop);
     while (pieces) {
         fromSquare = PopFirstBit(&pieces);
-        moves = GenerateMoves.Bish(occ, fromSquare) & empty;
+        moves = GenerateMoves.Bish(occ, fromSquare) & empty & LegalTargets(cd, fromSquare);
         SerializeMoves(list, fromSquare, moves);
     }
 
@@ -192,7 +215,7 @@ void FillQuietList(Position* pos, MoveList* list) {
     pieces = pos->Map(color, Rook);
     while (pieces) {
         fromSquare = PopFirstBit(&pieces);
-        moves = GenerateMoves.Rook(occ, fromSquare) & empty;
+        moves = GenerateMoves.Rook(occ, fromSquare) & empty & LegalTargets(cd, fromSquare);
         SerializeMoves(list, fromSquare, moves);
     }
 
@@ -200,13 +223,13 @@ void FillQuietList(Position* pos, MoveList* list) {
     pieces = pos->Map(color, Queen);
     while (pieces) {
         fromSquare = PopFirstBit(&pieces);
-        moves = GenerateMoves.Queen(pos->Occupied(), fromSquare) & empty;
+        moves = GenerateMoves.Queen(pos->Occupied(), fromSquare) & empty & LegalTargets(cd, fromSquare);
         SerializeMoves(list, fromSquare, moves);
     }
 
     // King moves
-    moves = GenerateMoves.King(pos->KingSq(color)) & empty;
-    SerializeMoves(list, pos->KingSq(color), moves);
+    moves = GenerateMoves.King(cd->kingSq) & empty;
+    SerializeKingMoves(pos, list, cd->kingSq, moves);
 }
 
 // So far, we are generating only direct checks here.
@@ -216,21 +239,23 @@ void FillQuietList(Position* pos, MoveList* list) {
 // This will be done at some stage, but is not
 // the top priority right now.
 
-void FillCheckList(Position* pos, MoveList* list) {
+void FillCheckList(Position* pos, MoveList* list, const CheckData* cd) {
+
+    PROFILE_SCOPE(profCheckGen);
 
     Bitboard pieces, moves, firstStep;
     Square fromSquare;
     const Color color = pos->GetSideToMove();
-    const Square kingSquare = pos->KingSq(~color);
     const Bitboard occ = pos->Occupied();
     const Bitboard empty = ~occ;
     const Bitboard pawns = pos->Map(color, Pawn);
     
-    // find locations from where the direct checks can be given
-    Bitboard pawnChecks = ForwardOf(SidesOf(Paint(kingSquare)), ~color);
-    Bitboard knightCheck = GenerateMoves.Knight(kingSquare);
-    Bitboard diagCheck = GenerateMoves.Bish(occ, kingSquare);
-    Bitboard straightCheck = GenerateMoves.Rook(occ, kingSquare);
+    // locations from where the direct checks can be given
+    // (calculated once per node, see SetCheckData())
+    const Bitboard pawnChecks = cd->checkSquares[Pawn];
+    const Bitboard knightCheck = cd->checkSquares[Knight];
+    const Bitboard diagCheck = cd->checkSquares[Bishop];
+    const Bitboard straightCheck = cd->checkSquares[Rook];
     
     if (color == White) {
 
@@ -238,12 +263,12 @@ void FillCheckList(Position* pos, MoveList* list) {
         firstStep = NorthOf(pos->Map(White, Pawn) & Mask.rank[rank2]) & empty;
         moves = NorthOf(firstStep) & empty;
         moves &= pawnChecks;
-        SerializePawnMoves(list, moves, -16, tPawnjump);
+        SerializePawnMoves(list, moves, -16, tPawnjump, cd);
 
         // White single pawn moves with check, excluding promotions
         moves = NorthOf(pos->Map(White, Pawn) & ~Mask.rank[rank7]) & empty;
         moves &= pawnChecks;
-        SerializePawnMoves(list, moves, -8, tNormal);
+        SerializePawnMoves(list, moves, -8, tNormal, cd);
     }
     else {
 
@@ -251,16 +276,16 @@ void FillCheckList(Position* pos, MoveList* list) {
         firstStep = SouthOf(pawns & Mask.rank[rank7]) & empty;
         moves = SouthOf(firstStep) & empty;
         moves &= pawnChecks;
-        SerializePawnMoves(list, moves, 16, tPawnjump);
+        SerializePawnMoves(list, moves, 16, tPawnjump, cd);
 
         // Black single pawn moves with check, excluding promotions
         moves = SouthOf(pos->Map(Black, Pawn) & ~Mask.rank[rank2]) & empty;
         moves &= pawnChecks;
-        SerializePawnMoves(list, moves, 8, tNormal);
+        SerializePawnMoves(list, moves, 8, tNormal, cd);
     }
 
     // Knight checks
-    pieces = pos->Map(color, Knight);
+    pieces = pos->Map(color, Knight) & ~cd->pinned;
     while (pieces) {
         fromSquare = PopFirstBit(&pieces);
         moves = GenerateMoves.Knight(fromSquare) & empty;
@@ -273,7 +298,7 @@ void FillCheckList(Position* pos, MoveList* list) {
     while (pieces) {
         fromSquare = PopFirstBit(&pieces);
         moves = GenerateMoves.Bish(occ, fromSquare) & empty;
-        moves &= diagCheck;
+        moves &= diagCheck & LegalTargets(cd, fromSquare);
         SerializeMoves(list, fromSquare, moves);
     }
 
@@ -282,7 +307,7 @@ void FillCheckList(Position* pos, MoveList* list) {
     while (pieces) {
         fromSquare = PopFirstBit(&pieces);
         moves = GenerateMoves.Rook(occ, fromSquare) & empty;
-        moves &= straightCheck;
+        moves &= straightCheck & LegalTargets(cd, fromSquare);
         SerializeMoves(list, fromSquare, moves);
     }
 
@@ -291,7 +316,7 @@ void FillCheckList(Position* pos, MoveList* list) {
     while (pieces) {
         fromSquare = PopFirstBit(&pieces);
         moves = GenerateMoves.Queen(occ, fromSquare) & empty;
-        moves &= straightCheck;
+        moves &= straightCheck & LegalTargets(cd, fromSquare);
         SerializeMoves(list, fromSquare, moves);
     }
 }
@@ -307,26 +332,49 @@ void SerializeMoves(MoveList* list, const Square fromSquare, Bitboard moves) {
         list->AddMove(fromSquare, PopFirstBit(&moves), 0);
 }
 
+// King moves are serialized like other pieces' moves,
+// but we test each destination square for attacks
+
+void SerializeKingMoves(Position* pos, MoveList* list, const Square kingSquare, Bitboard moves) {
+
+    Square toSquare;
+
+    while (moves) {
+        toSquare = PopFirstBit(&moves);
+        if (IsKingMoveLegal(pos, toSquare))
+            list->AddMove(kingSquare, toSquare, 0);
+    }
+}
+
 // Pawn move generation is done in bulk: we generate 
 // all the target squares for pawn moves in a specific 
 // direction (straight moves or diagonal captures).
 // Knowing the move direction, we infer fromSquare 
-// from toSquare and move vector.
+// from toSquare and move vector. Pinned pawns
+// cannot be handled in bulk, so we test them
+// one move at a time.
+
+static inline bool LeavesPinLine(const CheckData* cd, const Square fromSquare, const Square toSquare) {
 
-void SerializePawnMoves(MoveList* list, Bitboard moves, int vector, int flag) {
+    return (cd->pinned & Paint(fromSquare)) &&
+          !(Mask.line[cd->kingSq][fromSquare] & Paint(toSquare));
+}
+
+void SerializePawnMoves(MoveList* list, Bitboard moves, int vector, int flag, const CheckData* cd) {
 
     Square fromSquare, toSquare;
 
     while (moves) {
         toSquare = PopFirstBit(&moves);
         fromSquare = toSquare + vector;
-        list->AddMove(fromSquare, toSquare, flag);
+        if (!LeavesPinLine(cd, fromSquare, toSquare))
+            list->AddMove(fromSquare, toSquare, flag);
     }
 }
 
 // Promotions are serialized very much like pawn moves
 
-void SerializePromotions(MoveList* list, Bitboard moves, int vector) {
+void SerializePromotions(MoveList* list, Bitboard moves, int vector, const CheckData* cd) {
 
     Square fromSquare, toSquare;
 
@@ -334,6 +382,9 @@ void SerializePromotions(MoveList* list, Bitboard moves, int vector) {
         toSquare = PopFirstBit(&moves);
         fromSquare = toSquare + vector;
 
+        if (LeavesPinLine(cd, fromSquare, toSquare))
+            continue;
+
         list->AddMove(fromSquare, toSquare, tPromQ);
         list->AddMove(fromSquare, toSquare, tPromR);
         list->AddMove(fromSquare, toSquare, tPromB);
@@ -4,8 +4,9 @@
 #pragma once
 
 inline void SerializeMoves(MoveList* list, const Square fromSquare, Bitboard moves);
-inline void SerializePawnMoves(MoveList* list, Bitboard moves, int vector, int flag);
-void SerializePromotions(MoveList* list, Bitboard moves, int vector);
-void FillQuietList(Position* pos, MoveList* list);
-void FillNoisyList(Position* pos, MoveList* list);
-void FillCheckList(Position* pos, MoveList* list);
\ No newline at end of file
+void SerializeKingMoves(Position* pos, MoveList* list, const Square kingSquare, Bitboard moves);
+inline void SerializePawnMoves(MoveList* list, Bitboard moves, int vector, int flag, const CheckData* cd);
+void SerializePromotions(MoveList* list, Bitboard moves, int vector, const CheckData* cd);
+void FillQuietList(Position* pos, MoveList* list, const CheckData* cd);
+void FillNoisyList(Position* pos, MoveList* list, const CheckData* cd);
+void FillCheckList(Position* pos, MoveList* list, const CheckData* cd);
\ No newline at end of file
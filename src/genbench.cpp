@@ -0,0 +1,156 @@
+// Publius - Didactic public domain bitboard chess engine
+// by Pawel Koziol
+
+// Move generator benchmark. Sliding piece attacks can
+// be generated in three ways (see bitgen.cpp). GenBench()
+// times each of them in three settings: raw lookups
+// with random occupancies, full move generation
+// for a few positions and single-threaded perft without
+// hashing, which adds the cost of making moves.
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "types.h"
+#include "limits.h"
+#include "position.h"
+#include "movelist.h"
+#include "bitboard.h"
+#include "bitgen.h"
+#include "move.h"
+#include "legality.h"
+#include "gen.h"
+#include "timer.h"
+#include "uci.h"
+#include "publius.h"
+
+static const char* genBenchFens[] = {
+    startFen,
+    kiwipeteFen,
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -",                                   // rook endgame
+    "r3kbbr/pp1n1p1P/3ppnp1/q5N1/1P1pP3/P1N1B3/2P1QP2/R3KB1R b KQkq b3 0 17",  // promotions
+    "2rr2k1/1p4bp/p1q1p1p1/4Pp1n/2PB4/1PN3P1/P3Q2P/2RR2K1 w - f6 0 20",        // en passant
+};
+
+constexpr int lookupCalls = 1 << 22;
+constexpr int genCalls = 1 << 17;
+
+// Nanoseconds elapsed since start
+static double NsSince(std::chrono::steady_clock::time_point start) {
+
+    using namespace std::chrono;
+    return double(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+}
+
+// Bish() + Rook() for random squares and sparse occupancies,
+// resembling a middlegame board
+static double TimeLookups() {
+
+    unsigned long long seed = 2018;
+    volatile Bitboard sink = 0;
+    Bitboard acc = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < lookupCalls; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL; // 64-bit LCG
+        const Bitboard occ = seed & (seed >> 17) & (seed << 13);
+        const Square sq = (Square)(seed >> 58);
+        acc ^= GenerateMoves.Bish(occ, sq) ^ GenerateMoves.Rook(occ, sq);
+    }
+
+    sink = sink ^ acc;
+    return NsSince(start) / lookupCalls;
+}
+
+// Generating legal noisy and quiet moves for each test position
+static double TimeGeneration(Position* pos) {
+
+    MoveList list;
+    CheckData checkData;
+    volatile int sink = 0;
+    double ns = 0;
+
+    for (const char* fen : genBenchFens) {
+
+        pos->Set(fen);
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < genCalls; i++) {
+            list.Clear();
+            SetCheckData(pos, &checkData);
+            FillNoisyList(pos, &list, &checkData);
+            FillQuietList(pos, &list, &checkData);
+            sink = sink + list.GetLength();
+        }
+
+        ns += NsSince(start);
+    }
+
+    return ns / (genCalls * std::size(genBenchFens));
+}
+
+// Perft from each test position, returning milliseconds
+static Bitboard TimePerft(Position* pos, int depth, double& ms) {
+
+    Bitboard nodes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const char* fen : genBenchFens) {
+        pos->Set(fen);
+        nodes += Perft(pos, depth, 1, false, false);
+    }
+
+    ms = NsSince(start) / 1e6;
+    return nodes;
+}
+
+// Test positions are set up on a scratch board,
+// so the position of the game stays untouched
+void GenBench(int depth) {
+
+    Position pos[1];
+    const SliderType originalType = GenerateMoves.GetSliderType();
+    const bool wasLoaded = isNNUEloaded;
+
+    // We want to measure the move generator,
+    // not the accumulator updates
+    isNNUEloaded = false;
+
+    // Warm up, so that the first generator
+    // is not penalized for a cold CPU
+    TimeLookups();
+
+    std::cout << std::left << std::setw(14) << "generator"
+              << std::right << std::setw(12) << "lookup ns"
+              << std::setw(12) << "movegen ns"
+              << std::setw(12) << "perft ms"
+              << std::setw(12) << "perft Mnps"
+              << std::setw(14) << "nodes" << "\n";
+
+    for (int type = sliderKindergarten; type < sliderTypeCount; type++) {
+
+        if (!GenerateMoves.SetSliderType((SliderType)type)) {
+            std::cout << std::left << std::setw(14) << sliderNames[type]
+                      << " not compiled in\n";
+            continue;
+        }
+
+        double ms;
+        const double lookupNs = TimeLookups();
+        const double genNs = TimeGeneration(pos);
+        const Bitboard nodes = TimePerft(pos, depth, ms);
+
+        std::cout << std::left << std::setw(14) << sliderNames[type]
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << lookupNs
+                  << std::setw(12) << genNs
+                  << std::setw(12) << std::setprecision(0) << ms
+                  << std::setw(12) << std::setprecision(2) << (ms > 0 ? nodes / ms / 1000 : 0)
+                  << std::setw(14) << nodes << "\n" << std::flush;
+    }
+
+    GenerateMoves.SetSliderType(originalType);
+    isNNUEloaded = wasLoaded;
+}
@@ -4,7 +4,12 @@
 #include "types.h"
 #include "piece.h"
 #include "hashkeys.h"
+#include "bitboard.h"
+#include "bitgen.h"
+#include "position.h"
+#include "move.h"
 #include <random>
+#include <utility>
 
 std::mt19937_64 e2(2018);
 std::uniform_int_distribution<Bitboard> dist(std::llround(std::pow(2, 56)), std::llround(std::pow(2, 62)));
@@ -25,6 +30,54 @@ HashKeys::HashKeys() {
         enPassantKey[i] = Random64();
 }
 
+// Squares attacked by a piece standing on an empty board
+static Bitboard EmptyBoardAttacks(const PieceType pieceType, const Square square) {
+
+    switch (pieceType) {
+    case Knight: return GenerateMoves.Knight(square);
+    case Bishop: return GenerateMoves.Bish(0, square);
+    case Rook:   return GenerateMoves.Rook(0, square);
+    case Queen:  return GenerateMoves.Queen(0, square);
+    case King:   return GenerateMoves.King(square);
+    default:     return 0;
+    }
+}
+
+// Store key change of every move that a piece other than
+// a pawn can make on an empty board, side to move included.
+// On a collision, the old entry is kicked out to its other
+// slot, possibly kicking out yet another one. Needs attack
+// tables, so call it after GenerateMoves.Init().
+void HashKeys::InitCuckoo() {
+
+    for (int i = 0; i < cuckooSize; i++) {
+        cuckooKey[i] = 0;
+        cuckooMove[i] = 0;
+    }
+
+    for (ColoredPiece piece = WhiteKnight; piece < noPiece; ++piece)
+        for (Square s1 = A1; s1 < sqNone; ++s1)
+            for (Square s2 = Square(s1 + 1); s2 < sqNone; ++s2) {
+
+                if (!(EmptyBoardAttacks(TypeOfPiece(piece), s1) & Paint(s2)))
+                    continue;
+
+                Move move = CreateMove(s1, s2, 0);
+                Bitboard key = pieceKey[piece][s1] ^ pieceKey[piece][s2] ^ sideRandom;
+                int slot = CuckooSlot1(key);
+
+                while (true) {
+                    std::swap(cuckooKey[slot], key);
+                    std::swap(cuckooMove[slot], move);
+
+                    if (move == 0) // empty slot
+                        break;
+
+                    slot = (slot == CuckooSlot1(key)) ? CuckooSlot2(key) : CuckooSlot1(key);
+                }
+            }
+}
+
 Bitboard HashKeys::Random64(void) {
     return dist(e2);
 }
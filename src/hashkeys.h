@@ -4,6 +4,14 @@
 
 static constexpr auto sideRandom = ~((Bitboard)0);
 
+// Cuckoo table holds hash key changes caused by reversible
+// moves, each of them stored in one of two possible slots.
+// It is used to detect upcoming repetitions.
+constexpr int cuckooSize = 8192;
+
+constexpr int CuckooSlot1(const Bitboard key) { return key & (cuckooSize - 1); }
+constexpr int CuckooSlot2(const Bitboard key) { return (key >> 16) & (cuckooSize - 1); }
+
 class HashKeys {
 public:
     HashKeys(); // constructor
@@ -12,6 +20,9 @@ public:
     Bitboard pieceKey[12][64];
     Bitboard castleKey[16];
     Bitboard enPassantKey[8];
+    Bitboard cuckooKey[cuckooSize];
+    Move cuckooMove[cuckooSize];
+    void InitCuckoo();
 };
 
 extern HashKeys Key;
\ No newline at end of file
@@ -8,55 +8,44 @@
 #include "position.h"
 #include "move.h"
 #include "history.h"
-
-// Buckets are used to compress refutation table;
-// instead of [squareFrom][squareTo] we will use
-// [bucketOfSquareFrom] [squareTo]
-const int bucket[64] = {
-    0,  0,  1,  1,  2,  2,  3,  3,
-    0,  0,  1,  1,  2,  2,  3,  3,
-    4,  4,  5,  5,  6,  6,  7,  7,
-    4,  4,  5,  5,  6,  6,  7,  7,
-    8,  8,  9,  9, 10, 10, 11, 11,
-    8,  8,  9,  9, 10, 10, 11, 11,
-   12, 12, 13, 13, 14, 14, 15, 15,
-   12, 12, 13, 13, 14, 14, 15, 15
-};
+#include "publius.h"
+#include "profiler.h"
+
+// Refutation history used to be indexed by the side to move,
+// the previous move (bucket of its from square and its to square),
+// the piece, bucket of its from square and its to square. That
+// took 50 MB, so nearly every lookup was a cache miss. Now it
+// is indexed like a continuation history, by the piece that
+// made the previous move and its destination, followed by
+// the piece and destination of the current move (1.3 MB).
+// The piece already tells which side is to move.
 
 static constexpr int maxHist = 16384;
-static constexpr int refCount = 16 * 64;   // 1024 real contexts
-static constexpr int refNull = refCount;   // 1024 = dedicated null/none slot
-
-// returns index of a refutation move, based on 
-// bucket of from square [0..15] and to square [0..63]
-static inline int RefIndex(Move refuted) {
-    
-    if (!refuted)
-        return refNull; // 1024 (null / none)
-
-    const int rf = bucket[GetFromSquare(refuted)]; // 0..15
-    const int rt = int(GetToSquare(refuted));      // 0..63
-
-    return rf * 64 + rt; // 0..1023
-}
 
 // HistKey struct contains data for indexing history tables
 struct HistKey {
-    Color side;
-    int refIndex;
+    int refPiece;
+    int refTo;
     Square from;
-    int fromBucket;
     Square to;
     ColoredPiece piece;
 };
 
-// Initialize data for indexing the history tables
+// Initialize data for indexing the history tables.
+// Previous move has already been made, so the piece
+// that made it stands on its destination square.
 static inline HistKey MakeHistKey(Position* pos, Move move, Move refuted) {
     HistKey k;
-    k.side = pos->GetSideToMove();
-    k.refIndex = RefIndex(refuted);
+
+    if (!refuted || refuted == noPreviousMove) {
+        k.refPiece = noPiece;
+        k.refTo = refuted ? refCapture : refNull;
+    } else {
+        k.refTo = GetToSquare(refuted);
+        k.refPiece = pos->GetPiece((Square)k.refTo);
+    }
+
     k.from = GetFromSquare(move);
-    k.fromBucket = bucket[k.from];
     k.to = GetToSquare(move);
     k.piece = pos->GetPiece(k.from);
     return k;
@@ -88,6 +77,8 @@ void HistoryData::ClearOnNewGame() {
 // whether to penalize other quiet tries).
 bool HistoryData::Update(Position* pos, const Move move, const Move refuted, const int depth, const int ply) {
 
+    PROFILE_SCOPE(profHistory);
+
     // History is updated only for quiet moves
     if (IsMoveNoisy(pos, move))
         return false;
@@ -104,7 +95,7 @@ bool HistoryData::Update(Position* pos, const Move move, const Move refuted, con
     int bonus = Inc(depth);
 
     ApplyHistoryDelta(cutoffHistory[k.piece][k.from][k.to], +bonus);
-    ApplyHistoryDelta(refutation[k.side][k.refIndex][k.piece][k.fromBucket][k.to], +bonus);
+    ApplyHistoryDelta(refutation[k.refPiece][k.refTo][k.piece][k.to], +bonus);
 
 
     return true;
@@ -113,6 +104,8 @@ bool HistoryData::Update(Position* pos, const Move move, const Move refuted, con
 // Negative update for the moves that did not cause a beta cutoff
 void HistoryData::UpdateTries(Position* pos, const Move move, const Move refuted, const int depth) {
 
+    PROFILE_SCOPE(profHistory);
+
     // Update only for quiet moves
     if (IsMoveNoisy(pos, move))
         return;
@@ -121,7 +114,7 @@ void HistoryData::UpdateTries(Position* pos, const Move move, const Move refuted
     int bonus = Dec(depth);
 
     ApplyHistoryDelta(cutoffHistory[k.piece][k.from][k.to], -bonus);
-    ApplyHistoryDelta(refutation[k.side][k.refIndex][k.piece][k.fromBucket][k.to], -bonus);
+    ApplyHistoryDelta(refutation[k.refPiece][k.refTo][k.piece][k.to], -bonus);
 }
 
 // Is a move the killer move for the current ply?
@@ -145,7 +138,7 @@ int HistoryData::GetScore(Position* pos, const Move move, const Move refuted) {
     HistKey k = MakeHistKey(pos, move, refuted);
 
     return cutoffHistory[k.piece][k.from][k.to]
-         + refutation[k.side][k.refIndex][k.piece][k.fromBucket][k.to];
+         + refutation[k.refPiece][k.refTo][k.piece][k.to];
 }
 
 // Bonus for a beta cutoff
@@ -7,6 +7,17 @@
 #include "position.h"
 #include "move.h"
 
+// Stands for the previous move after a capture, so that quiet
+// moves are not scored as refutations of the capture. It is
+// an impossible move, so it cannot collide with a real one.
+constexpr Move noPreviousMove = CreateMove(A8, C1, 0);
+
+// Refutation history is indexed by the piece that made
+// the previous move and its destination square. The last
+// row holds the contexts without a previous move.
+constexpr int refNull = 0;    // after a null move
+constexpr int refCapture = 1; // after a capture (noPreviousMove)
+
 class HistoryData {
 public:
     HistoryData();
@@ -37,7 +48,7 @@ private:
 
     // History data
     int16_t cutoffHistory[noPiece][sqNone][sqNone];
-    int16_t refutation[2][1025][noPiece][sqNone / 4][sqNone];
+    int16_t refutation[noPiece + 1][sqNone][noPiece][sqNone];
 
     // Killer moves per ply
     Move killer1[SearchTreeSize];
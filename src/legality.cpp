@@ -3,7 +3,10 @@
 
 // This  file contains functions detecting whether a move  is 
 // pseudo-legal. This means testing all the conditions except
-// the in check status, which is dealt with during the search.
+// the in check status. Pin and check information, calculated
+// once per node, lets the move generator and IsLegal() deal
+// with the in check status, so that search never has to play
+// an illegal move and take it back.
 
 #include "types.h"
 #include "piece.h"
@@ -11,12 +14,126 @@
 #include "bitboard.h"
 #include "position.h"
 #include "move.h"
+#include "mask.h"
+#include "bitgen.h"
 #include "legality.h"
 #include "publius.h"
 #include <iostream>
 
+// Find pieces of the blocker color standing alone between
+// a slider of the attacker color and the king on kingSq.
+// Sliders are found as if pieces of the blocker color were
+// removed from the board, then we count what stands between.
+static Bitboard SingleBlockers(const Position* pos, const Square kingSq,
+                               const Color attacker, const Color blocker) {
+
+    const Bitboard others = pos->Pieces(~blocker);
+    const Bitboard occ = pos->Occupied();
+    Bitboard result = 0;
+
+    Bitboard snipers = (GenerateMoves.Bish(others, kingSq) & pos->MapDiagonalSliders(attacker))
+                     | (GenerateMoves.Rook(others, kingSq) & pos->MapStraightSliders(attacker));
+
+    while (snipers) {
+        const Square sniperSq = PopFirstBit(&snipers);
+        const Bitboard blockers = Mask.between[kingSq][sniperSq] & occ;
+
+        // exactly one piece in between, and of the right color
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & pos->Pieces(blocker)))
+            result |= blockers;
+    }
+
+    return result;
+}
+
+// Find checkers, pinned pieces, discovered check candidates
+// and squares from which our pieces would check enemy king
+void SetCheckData(const Position* pos, CheckData* cd) {
+
+    const Color color = pos->GetSideToMove();
+    const Square kingSq = pos->KingSq(color);
+    const Square enemyKingSq = pos->KingSq(~color);
+    const Bitboard occ = pos->Occupied();
+
+    cd->kingSq = kingSq;
+    cd->enemyKingSq = enemyKingSq;
+    cd->checkers = pos->AttacksTo(kingSq) & pos->Pieces(~color);
+    cd->pinned = SingleBlockers(pos, kingSq, ~color, color);
+    cd->discoverers = SingleBlockers(pos, enemyKingSq, color, color);
+
+    cd->checkSquares[Pawn] = GenerateMoves.Pawn(~color, enemyKingSq);
+    cd->checkSquares[Knight] = GenerateMoves.Knight(enemyKingSq);
+    cd->checkSquares[Bishop] = GenerateMoves.Bish(occ, enemyKingSq);
+    cd->checkSquares[Rook] = GenerateMoves.Rook(occ, enemyKingSq);
+    cd->checkSquares[Queen] = cd->checkSquares[Bishop] | cd->checkSquares[Rook];
+    cd->checkSquares[King] = 0;
+
+    if (!cd->checkers)
+        cd->checkMask = ~0ULL;
+    else if (cd->checkers & (cd->checkers - 1))
+        cd->checkMask = 0; // double check, only king can move
+    else
+        cd->checkMask = cd->checkers | Mask.between[kingSq][FirstOne(cd->checkers)];
+}
+
+// Detect if a pseudo-legal move leaves own king in check
+bool IsLegal(Position* pos, const CheckData* cd, const Move move) {
+
+    const Square fromSquare = GetFromSquare(move);
+    const Square toSquare = GetToSquare(move);
+
+    if (fromSquare == cd->kingSq) {
+
+        // castling functions test all the squares king passes
+        if (GetTypeOfMove(move) == tCastle)
+            return true;
+
+        return IsKingMoveLegal(pos, toSquare);
+    }
+
+    if (GetTypeOfMove(move) == tEnPassant)
+        return IsEnPassantLegal(pos, fromSquare, toSquare);
+
+    if (!(cd->checkMask & Paint(toSquare)))
+        return false;
+
+    return !(cd->pinned & Paint(fromSquare)) ||
+            (Mask.line[cd->kingSq][fromSquare] & Paint(toSquare));
+}
+
+// Is king's destination square safe? King is removed
+// from the board, so that it cannot hide behind itself
+// when retreating along the line of a slider's attack.
+bool IsKingMoveLegal(Position* pos, const Square toSquare) {
+
+    const Color color = pos->GetSideToMove();
+    const Bitboard occ = pos->Occupied() ^ Paint(pos->KingSq(color));
+
+    return !((pos->Map(~color, Pawn) & GenerateMoves.Pawn(color, toSquare)) ||
+             (pos->Map(~color, Knight) & GenerateMoves.Knight(toSquare)) ||
+             (pos->MapDiagonalSliders(~color) & GenerateMoves.Bish(occ, toSquare)) ||
+             (pos->MapStraightSliders(~color) & GenerateMoves.Rook(occ, toSquare)) ||
+             (pos->Map(~color, King) & GenerateMoves.King(toSquare)));
+}
+
+// En passant removes two pieces from a rank, so it can
+// expose the king in ways that a pin mask cannot describe.
+// We update occupancy and test for attacks directly.
+bool IsEnPassantLegal(Position* pos, const Square fromSquare, const Square toSquare) {
+
+    const Color color = pos->GetSideToMove();
+    const Square kingSq = pos->KingSq(color);
+    const Bitboard captured = Paint(toSquare ^ 8);
+    const Bitboard occ = (pos->Occupied() ^ Paint(fromSquare) ^ captured) | Paint(toSquare);
+
+    return !(((pos->Map(~color, Pawn) & ~captured) & GenerateMoves.Pawn(color, kingSq)) ||
+             (pos->Map(~color, Knight) & GenerateMoves.Knight(kingSq)) ||
+             (pos->MapDiagonalSliders(~color) & GenerateMoves.Bish(occ, kingSq)) ||
+             (pos->MapStraightSliders(~color) & GenerateMoves.Rook(occ, kingSq)));
+}
+
 // Detect if a move is pseudo-legal
-bool IsPseudoLegal(Position* pos, int move) {
+bool IsPseudoLegal(Position* pos, const Move move) {
 
     // NOTE: a move is not guaranteed to work in the  current
     // position,  this is why we are testing it in the  first
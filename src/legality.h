@@ -3,7 +3,13 @@
 
 #pragma once
 
-bool IsPseudoLegal(Position* pos, int move);
+// Legality tests use CheckData, defined in position.h
+// together with SetCheckData().
+
+bool IsLegal(Position* pos, const CheckData* cd, const Move move);
+bool IsKingMoveLegal(Position* pos, const Square toSquare);
+bool IsEnPassantLegal(Position* pos, const Square fromSquare, const Square toSquare);
+bool IsPseudoLegal(Position* pos, const Move move);
 bool IsCastlingLegal(Position* pos, const MoveDescription* md);
 bool IsPawnJumpLegal(Position* pos, const MoveDescription* md);
 bool IsPawnMoveLegal(const MoveDescription* md);
\ No newline at end of file
@@ -1,37 +1,26 @@
 // Publius - Didactic public domain bitboard chess engine 
 // by Pawel Koziol
 
+#include <vector>
 #include "types.h"
 #include "limits.h"
 #include "position.h"
 #include "movelist.h"
 #include "history.h"
 #include "move.h"
-
-// Swaps moves on the list between slots i and j
-void MoveList::SwapMoves(const int i, const int j) {
-
-    Move tmpMove = moves[i];
-    int tmpVal = values[i];
-    moves[i] = moves[j];
-    values[i] = values[j];
-    moves[j] = tmpMove;
-    values[j] = tmpVal;
-}
+#include "publius.h"
 
 // Add a preexisting move to the list
 void MoveList::AddMove(Move move) {
 
-    moves[ind] = move;
-    values[ind] = -4 * HistLimit;
+    entries[ind] = PackEntry(move, lowestScore);
     ind++;
 }
 
 // Create a move and add it to the list
 void MoveList::AddMove(Square fromSquare, Square toSquare, int flag) {
 
-    moves[ind] = CreateMove(fromSquare, toSquare, flag);
-    values[ind] = -4 * HistLimit;
+    entries[ind] = PackEntry(CreateMove(fromSquare, toSquare, flag), lowestScore);
     ind++;
 }
 
@@ -47,35 +36,116 @@ void MoveList::Clear() {
 Move MoveList::GetNextRawMove() {
 
     if (get < ind)
-        return moves[get++];
+        return EntryMove(entries[get++]);
 
     return 0; // 0 means "no more moves"
 }
 
-// Get the best remaining move from a sorted list
+// Remove the moves that don't give check from the part
+// of the list that has not been returned yet, keeping
+// the order of the remaining moves. Returns the number
+// of moves removed.
+
+int MoveList::RemoveNonChecks(Position* pos) {
+
+    int last = get;
+
+    for (int i = get; i < ind; i++)
+        if (pos->MoveGivesCheck(EntryMove(entries[i])))
+            entries[last++] = entries[i];
+
+    const int removed = ind - last;
+    ind = last;
+    return removed;
+}
+
+// Is the move in the part of the list
+// that has not been returned yet?
+
+bool MoveList::IsPending(const Move move) {
+
+    for (int i = get; i < ind; i++)
+        if (EntryMove(entries[i]) == move)
+            return true;
+
+    return false;
+}
+
+// Get the best remaining move from a scored list.
+// Picking the best move by a linear scan at every call
+// costs O(n^2) if all the moves are tried, but the first
+// move often causes a cutoff. So the first move is picked
+// by a scan and the rest of the list is sorted only if we
+// ask for the second move. Either way moves come out
+// in the same order as from a stable sort.
 
 Move MoveList::GetBestMove() { 
 
-    Move move;
-    int min = -4 * HistLimit;
-    int score = min;
-    int loc = 0;
+    if (get >= ind)
+        return 0;
 
-    for (int i = get; i < ind; i++) {
-       if (values[i] > score) {
-          score = values[i];
-          loc = i;
-       }
+    if (!isSorted) {
+        if (get == 0)
+            MoveBestToFront(entries, entries + ind);
+        else {
+            SortEntries(entries + get, entries + ind);
+            isSorted = true;
+        }
     }
 
-    values[loc] = min;
-    move = moves[loc];
-    if (loc > get) 
-        SwapMoves(loc, get);
+    return EntryMove(entries[get++]);
+}
+
+// Sort entries by score, best first. Scores are compared
+// without unpacking them, as they occupy the high bits.
+// Lists are short and usually partly ordered by generation,
+// so insertion sort beats std::sort here. It is also stable,
+// moves with equal scores keep their generation order.
+
+void SortEntries(MoveEntry* first, MoveEntry* last) {
+
+    for (MoveEntry* p = first + 1; p < last; p++) {
 
-    get++;
-    return move; 
-};
+        const MoveEntry entry = *p;
+        const MoveEntry key = entry >> moveBits;
+        MoveEntry* q = p;
+
+        while (q > first && (*(q - 1) >> moveBits) < key) {
+            *q = *(q - 1);
+            q--;
+        }
+
+        *q = entry;
+    }
+}
+
+// Move the first entry with the highest score to the front,
+// keeping the order of the entries it jumps over
+
+void MoveBestToFront(MoveEntry* first, MoveEntry* last) {
+
+    MoveEntry* best = first;
+
+    for (MoveEntry* p = first + 1; p < last; p++)
+        if ((*p >> moveBits) > (*best >> moveBits))
+            best = p;
+
+    const MoveEntry entry = *best;
+    for (; best > first; best--)
+        *best = *(best - 1);
+    *first = entry;
+}
+
+// Called by the scoring functions
+void MoveList::PrepareSort() {
+
+#ifdef USE_RECORDERS
+    if (recorder)
+        recorder->emplace_back(entries + get, entries + ind);
+#endif
+
+    isSorted = false;
+}
 
 // Score moves that change material balance (captures,
 // including en passant, and promotions). Function
@@ -87,18 +157,22 @@ void MoveList::ScoreNoisy(Position* pos) {
 
     for (int i = 0; i < ind; i++) {
 
+        const Move move = EntryMove(entries[i]);
+
         // Promotion
-        if (IsMovePromotion(moves[i]))
-            values[i] = GetPromotedPiece(moves[i]) - 5;
+        if (IsMovePromotion(move))
+            SetScore(i, GetPromotedPiece(move) - 5);
 
         // Most valuable victim/least valuable attacker
-        else if (pos->IsOccupied(GetToSquare(moves[i])))
-            values[i] = 6 * pos->PieceTypeOnSq(GetToSquare(moves[i]))
-                      + 5 - pos->PieceTypeOnSq(GetFromSquare(moves[i]));
+        else if (pos->IsOccupied(GetToSquare(move)))
+            SetScore(i, 6 * pos->PieceTypeOnSq(GetToSquare(move))
+                      + 5 - pos->PieceTypeOnSq(GetFromSquare(move)));
         
         // Default, handles en passant
-        else values [i] = 5;
+        else SetScore(i, 5);
     }
+
+    PrepareSort();
 }
 
 // Score quiet moves. Function relies on staged move 
@@ -108,5 +182,7 @@ void MoveList::ScoreNoisy(Position* pos) {
 void MoveList::ScoreQuiet(Position* pos, const Move refuted) {
 
     for (int i = 0; i < ind; i++)
-        values[i] = History.GetScore(pos, moves[i], refuted);
+        SetScore(i, History.GetScore(pos, EntryMove(entries[i]), refuted));
+
+    PrepareSort();
 }
\ No newline at end of file
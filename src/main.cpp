@@ -28,6 +28,8 @@ HistoryData History;
 TransTable TT;
 LmrData Lmr;
 PvCollector Pv;
+RepetitionStack GameRepetitions;
+RepetitionStack ScratchRepetitions;
 Net NN;
 bool isNNUEloaded;
 bool isUci;
@@ -35,13 +37,18 @@ int nnueWeight;
 int hceWeight;
 int multiPv;
 
-int main() {
+int main(int argc, char* argv[]) {
 
 #ifdef USE_TUNING
     std::cout << "This version uses tuning and can win by memory hogging\n"
               << "Comment out USE_TUNING in publius.h and recompile\n";
 #endif
 
+#ifdef VERIFY_NNUE
+    std::cout << "This version verifies NNUE accumulator at every node and is slow\n"
+              << "Comment out VERIFY_NNUE in publius.h and recompile\n";
+#endif
+
     multiPv = 1;
     isUci = false;
     isNNUEloaded = false;
@@ -50,7 +57,11 @@ int main() {
     hceWeight = 0;
     TryLoadingNNUE(netPath);
     GenerateMoves.Init();
-    UciLoop();
+    Key.InitCuckoo();
+    if (argc > 1)
+        RunCommandLine(argc, argv);
+    else
+        UciLoop();
     TT.Exit();
     return 0;
 }
\ No newline at end of file
@@ -13,6 +13,7 @@ MaskData::MaskData() {
     InitPassedMask();
     InitAdjacentMask();
     InitPawnSupport();
+    InitLines();
 
     // Init king attack table
     for (int i = 0; i < 255; i++)
@@ -64,6 +65,41 @@ void MaskData::InitAdjacentMask() {
         adjacentFiles[f] = WestOf(file[f]) | EastOf(file[f]);
 }
 
+// Lines and segments connecting squares on the same
+// rank, file or diagonal, used for detecting pins
+// and for blocking checks. Both masks stay empty
+// for squares that are not aligned.
+void MaskData::InitLines() {
+
+    using Step = Bitboard(*)(Bitboard);
+    const Step steps[4][2] = { { NorthOf, SouthOf },
+                               { WestOf, EastOf },
+                               { NWOf, SEOf },
+                               { NEOf, SWOf } };
+
+    for (Square square = A1; square < sqNone; ++square) {
+        for (const auto& pair : steps) {
+
+            // full line through a square
+            Bitboard fullLine = Paint(square);
+            for (const Step step : pair)
+                for (Bitboard b = step(Paint(square)); b; b = step(b))
+                    fullLine |= b;
+
+            // walk each ray, remembering squares passed so far
+            for (const Step step : pair) {
+                Bitboard ray = 0;
+                for (Bitboard b = step(Paint(square)); b; b = step(b)) {
+                    const Square target = FirstOne(b);
+                    between[square][target] = ray;
+                    line[square][target] = fullLine;
+                    ray |= b;
+                }
+            }
+        }
+    }
+}
+
 void MaskData::InitPawnSupport() {
 
     for (Square square = A1; square < 64; ++square) {
@@ -8,6 +8,7 @@ private:
     void InitPassedMask();
     void InitAdjacentMask();
     void InitPawnSupport();
+    void InitLines();
 public:
     
     static constexpr int castle[64] = {
@@ -29,6 +30,8 @@ public:
     Bitboard strongPawn[2][64];
     Bitboard support[2][64];
     Bitboard adjacentFiles[8];
+    Bitboard between[64][64]; // squares between two aligned squares
+    Bitboard line[64][64];    // entire line through two aligned squares
     MaskData(); // constructor
 };
 
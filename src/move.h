@@ -22,7 +22,7 @@
 [[nodiscard]] constexpr Move CreateMove(const Square fromSquare,
                                         const Square toSquare,
                                         const int flag) {
-    return (flag << 12) | (toSquare << 6) | fromSquare;
+    return static_cast<Move>((flag << 12) | (toSquare << 6) | fromSquare);
 }
 
 [[nodiscard]] constexpr bool IsMovePromotion(const Move move) {
@@ -6,9 +6,14 @@
 #include "hashkeys.h"
 #include "piece.h"
 #include "move.h"
+#include "nn.h"
+#include "publius.h" // for VERIFY_NNUE
+#include "profiler.h"
 
 void Position::DoMove(const Move move, UndoData *undo) {
 
+    PROFILE_SCOPE(profDoMove);
+
     // Describe move (better than loose variables)
     const MoveDescription md(*this, move);
 
@@ -20,9 +25,15 @@ void Position::DoMove(const Move move, UndoData *undo) {
     undo->reversibleMoves = reversibleMoves;
     undo->boardHash = boardHash;
     undo->pawnHash = pawnKingHash;
+    SaveCheckData(undo);
 
     // Update repetition list
-    repetitionList[repetitionIndex++] = boardHash;
+    repetitions->Push(boardHash);
+    pliesFromNull++;
+
+#ifdef VERIFY_NNUE
+    RememberMove(move);
+#endif
 
     // Capture enemy piece
     if (md.prey != noPieceType) {
@@ -95,11 +106,18 @@ void Position::DoNull(UndoData* undo) {
     // Save stuff
     undo->move = 0;
     undo->enPassantSq = enPassantSq;
+    undo->pliesFromNull = pliesFromNull;
     undo->boardHash = boardHash;
+    SaveCheckData(undo);
 
     // Update repetition list
-    repetitionList[repetitionIndex++] = boardHash;
+    repetitions->Push(boardHash);
     reversibleMoves++;
+    pliesFromNull = 0;
+
+#ifdef VERIFY_NNUE
+    RememberMove(0);
+#endif
 
     ClearEnPassant();
     sideToMove = ~sideToMove;
@@ -3,21 +3,55 @@
 
 #pragma once
 
+#include <vector>
+
 constexpr int MoveListSize = 256;
 
+// Each list entry packs a move and its sort score. A move uses
+// 15 bits, leaving 17 bits for the score, which is more than
+// enough for history (twice a 15-bit value) and capture scores.
+// Score is stored with an offset, so that entries are unsigned
+// and unscored moves, stored with score 0, come last.
+
+typedef std::uint32_t MoveEntry;
+
+constexpr int moveBits = 15;
+constexpr MoveEntry moveMask = (1 << moveBits) - 1;
+constexpr int scoreOffset = 1 << 16;
+constexpr int lowestScore = -scoreOffset;
+
+[[nodiscard]] constexpr MoveEntry PackEntry(const Move move, const int score) {
+    return ((MoveEntry)(score + scoreOffset) << moveBits) | move;
+}
+
+[[nodiscard]] constexpr Move EntryMove(const MoveEntry entry) {
+    return (Move)(entry & moveMask);
+}
+
+[[nodiscard]] constexpr int EntryScore(const MoveEntry entry) {
+    return (int)(entry >> moveBits) - scoreOffset;
+}
+
+void SortEntries(MoveEntry* first, MoveEntry* last);
+void MoveBestToFront(MoveEntry* first, MoveEntry* last);
+
 class MoveList {
 private:
-    Move moves[MoveListSize];
-    int values[MoveListSize];
+    MoveEntry entries[MoveListSize];
     int ind;
     int get;
-    void SwapMoves(const int i, const int j);
+    bool isSorted;
+    void SetScore(const int i, const int score) { entries[i] = PackEntry(EntryMove(entries[i]), score); }
+    void PrepareSort();
 public:
+    inline static std::vector<std::vector<MoveEntry>>* recorder = nullptr; // set only by sortbench
     void Clear();
     void AddMove(Square fromSquare, Square toSquare, int flag);
     void AddMove(Move move);
     Move GetNextRawMove();
     Move GetBestMove();
+    int RemoveNonChecks(Position* pos);
+    bool IsPending(const Move move);
     void ScoreNoisy(Position* pos);
     void ScoreQuiet(Position* pos, const Move refuted);
 
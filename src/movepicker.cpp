@@ -11,6 +11,11 @@
 // table and killer moves in the mix (removing 
 // this feature failed a SPRT test).
 
+// All the moves returned by MovePicker are legal,
+// so the caller does not need to test whether
+// own king is in check after making a move. When
+// in check, generators emit only evasions.
+
 #include "types.h"
 #include "position.h"
 #include "movelist.h"
@@ -19,10 +24,13 @@
 #include "gen.h"
 #include "badcapture.h"
 #include "movepicker.h"
+#include "publius.h"
+#include "searchstats.h"
 
 //Initialize with the move ordering data
-void MovePicker::Init(const Mode mode, const Move ttMove, const Move firstKiller, const Move secondKiller, const Move refuted) {
+void MovePicker::Init(PickerLists* plyLists, const Mode mode, const Move ttMove, const Move firstKiller, const Move secondKiller, const Move refuted) {
     
+    lists = plyLists;
     moveFromTT = ttMove;
     killer1 = firstKiller;
     killer2 = secondKiller;
@@ -30,6 +38,7 @@ void MovePicker::Init(const Mode mode, const Move ttMove, const Move firstKiller
     currentMoveStage = stageTT;
     movegenMode = mode;
     refutedMove = refuted;
+    isSkippingQuiets = false;
 }
 
 // Emits the next move
@@ -42,35 +51,19 @@ Move MovePicker::NextMove(Position* pos) {
             case stageTT:
             {
                 stage = stageGenCapt;
-                if (moveFromTT && IsPseudoLegal(pos, moveFromTT))
+                if (moveFromTT && 
+                    IsPseudoLegal(pos, moveFromTT) && 
+                    IsLegal(pos, pos->GetCheckData(), moveFromTT))
                     return moveFromTT;
                 break;
             }
 
             case stageGenCapt:
             {
-                allNoisyList.Clear();
-                FillNoisyList(pos, &allNoisyList);
-                goodNoisyList.Clear();
-                badNoisyList.Clear();
-
-                // split noisy moves into "good"
-                // (good or equal captures) and "bad"
-                // (presumably losing material)
-                while (true) {
-                    move = allNoisyList.GetNextRawMove();
-                    if (move == 0) 
-                        break;
-                    IsBadCapture(pos, move) ? badNoisyList.AddMove(move)
-                                            : goodNoisyList.AddMove(move);
-                }
-                stage = stagePrepareGood;
-                break;
-            }
-
-            case stagePrepareGood:
-            {
-                PrepareNoisyList(pos, goodNoisyList, goodNoisyLength, goodNoisyCnt);
+                lists->allNoisy.Clear();
+                FillNoisyList(pos, &lists->allNoisy, pos->GetCheckData());
+                lists->badNoisy.Clear();
+                PrepareNoisyList(pos, lists->allNoisy, noisyLength, noisyCnt);
                 stage = stageReturnGoodCapt;
                 currentMoveStage = stageReturnGoodCapt;
                 break;
@@ -78,11 +71,26 @@ Move MovePicker::NextMove(Position* pos) {
 
             case stageReturnGoodCapt:
             {
-                while (goodNoisyCnt < goodNoisyLength) {
-                    move = goodNoisyList.GetBestMove();
-                    goodNoisyCnt++;
+                // Noisy moves are returned in MVV/LVA order.
+                // Only when a move is about to be returned,
+                // we check whether it is "good" (good or equal
+                // capture) or "bad" (presumably losing material).
+                // Bad moves are deferred until after the quiet 
+                // moves. This way, if an early capture causes 
+                // a cutoff, we don't evaluate the remaining ones.
+                while (noisyCnt < noisyLength) {
+                    move = lists->allNoisy.GetBestMove();
+                    noisyCnt++;
+
+                    // Move from the TT has already been tried
                     if (move == moveFromTT)
-                        continue;  // Avoid returning moveFromTT again
+                        continue;
+
+                    if (IsBadNoisy(pos, move)) {
+                        lists->badNoisy.AddMove(move);
+                        continue;
+                    }
+
                     return move;
                 }
 
@@ -119,12 +127,16 @@ Move MovePicker::NextMove(Position* pos) {
 
             case stageGenQuiet:
             {
-                quietList.Clear();
-                (movegenMode == modeChecks) ? FillCheckList(pos, &quietList) 
-                                            : FillQuietList(pos, &quietList);
+                lists->quiet.Clear();
+                (movegenMode == modeChecks) ? FillCheckList(pos, &lists->quiet, pos->GetCheckData()) 
+                                            : FillQuietList(pos, &lists->quiet, pos->GetCheckData());
+
+                // Don't score moves that would be pruned anyway
+                if (isSkippingQuiets)
+                    RemoveNonChecks(pos);
 
-                quietList.ScoreQuiet(pos, refutedMove);
-                quietLength = quietList.GetLength();
+                lists->quiet.ScoreQuiet(pos, refutedMove);
+                quietLength = lists->quiet.GetLength();
                 quietCnt = 0;
                 stage = stageReturnQuiet;
                 currentMoveStage = stageReturnQuiet;
@@ -134,7 +146,7 @@ Move MovePicker::NextMove(Position* pos) {
             case stageReturnQuiet:
             {
                 while (quietCnt < quietLength) {
-                    move = quietList.GetBestMove();
+                    move = lists->quiet.GetBestMove();
                     quietCnt++;
                     
                     // Avoid returning moves tried at the earlier stages
@@ -152,7 +164,7 @@ Move MovePicker::NextMove(Position* pos) {
 
             case stagePrepareBad:
             {
-                PrepareNoisyList(pos, badNoisyList, badNoisyLength, badNoisyCnt);
+                PrepareNoisyList(pos, lists->badNoisy, badNoisyLength, badNoisyCnt);
                 stage = stageReturnBad;
                 currentMoveStage = stageReturnBad;
                 break;
@@ -160,12 +172,9 @@ Move MovePicker::NextMove(Position* pos) {
 
             case stageReturnBad:
             {
-                while (badNoisyCnt < badNoisyLength) {
-                    move = badNoisyList.GetBestMove();
+                if (badNoisyCnt < badNoisyLength) {
                     badNoisyCnt++;
-                    if (move == moveFromTT)
-                        continue;
-                    return move;
+                    return lists->badNoisy.GetBestMove();
                 }
                 stage = stageEnd;
                 break;
@@ -178,7 +187,7 @@ Move MovePicker::NextMove(Position* pos) {
 }
 
 // Scores a noisy move list and initializes counters.
-// Used for both goodNoisyList and badNoisyList.
+// Used for both lists->allNoisy and lists->badNoisy.
 void MovePicker::PrepareNoisyList(Position* pos, MoveList& list, int& length, int& cnt) {
 
     list.ScoreNoisy(pos);
@@ -193,5 +202,56 @@ bool MovePicker::IsAcceptableKiller(Position* pos, const Move killer) {
     return (killer && 
             killer != moveFromTT && 
            !IsMoveNoisy(pos, killer) && 
-            IsPseudoLegal(pos, killer));
-}
\ No newline at end of file
+            IsPseudoLegal(pos, killer) &&
+            IsLegal(pos, pos->GetCheckData(), killer));
+}
+
+// Does a noisy move appear to lose material?
+bool MovePicker::IsBadNoisy(Position* pos, const Move move) {
+
+    if (IsGoodByValue(pos, move))
+        return false;
+
+    // We must resort to static exchange evaluator
+    return !SeeGe(pos, move, 0);
+}
+
+// Search tells us that it is going to prune all the remaining
+// quiet moves, except those that give check. If quiet moves 
+// are not generated yet, we will filter them before scoring.
+// Otherwise we filter the part of the list not returned yet.
+// Either way the checks come in the same order as before.
+void MovePicker::SkipQuiets(Position* pos, const QuietPruning reason) {
+
+    if (isSkippingQuiets)
+        return;
+
+    isSkippingQuiets = true;
+    skipReason = reason;
+
+    if (stage == stageReturnQuiet) {
+        RemoveNonChecks(pos);
+        quietLength = lists->quiet.GetLength();
+    }
+}
+
+// Drops quiet moves that don't give check. They count as pruned
+// by the technique that asked to skip them, except for the move
+// from the TT and killers, which were tried at earlier stages.
+void MovePicker::RemoveNonChecks(Position* pos) {
+
+    int triedCount = 0;
+
+#ifdef USE_SEARCH_STATS
+    const Move tried[3] = { moveFromTT,
+                            killer1 != moveFromTT ? killer1 : 0,
+                            killer2 != moveFromTT && killer2 != killer1 ? killer2 : 0 };
+
+    for (const Move move : tried)
+        if (lists->quiet.IsPending(move) && !pos->MoveGivesCheck(move))
+            triedCount++;
+#endif
+
+    const int removed = lists->quiet.RemoveNonChecks(pos);
+    CountStat(skipReason == pruneFutility ? statFutilityPrunes : statLmpPrunes, removed - triedCount);
+}
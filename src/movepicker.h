@@ -27,9 +27,8 @@
 
 enum MovegenStage {
     stageTT,              // return move from transposition table 
-    stageGenCapt,         // generate noisy moves, split them to good and bad
-    stagePrepareGood,     // score good noisies
-    stageReturnGoodCapt,  // return good noisies
+    stageGenCapt,         // generate and score noisy moves
+    stageReturnGoodCapt,  // return good noisies, deferring bad ones
     stageFirstKiller,     // first killer move
     stageSecondKiller,    // second killer move
     stageGenQuiet,        // generate and score quiet moves
@@ -46,21 +45,39 @@ enum Mode { modeAll,        // main search or check evasion in qs
             modeChecks,     // check-aware quiescence search
             modeCaptures }; // basic (late) quiescence search
 
+// Move lists used by MovePicker. They are kept in a per-search
+// arena indexed by ply (see SearchContext), so that MovePicker
+// itself is a small object and search frames stay compact.
+
+struct PickerLists {
+    MoveList allNoisy, badNoisy, quiet;
+};
+
+// Reason for skipping quiet moves, so that search
+// statistics can tell how many moves each pruning drops
+
+enum QuietPruning { pruneFutility, pruneLateMove };
+
 class MovePicker {
 private:
     Mode movegenMode;
-    int goodNoisyLength, badNoisyLength, quietLength;
-    int goodNoisyCnt, badNoisyCnt, quietCnt;
+    int noisyLength, badNoisyLength, quietLength;
+    int noisyCnt, badNoisyCnt, quietCnt;
     MovegenStage stage;
-    MoveList allNoisyList, goodNoisyList, badNoisyList, quietList;
+    PickerLists* lists;
     Move moveFromTT;
     Move killer1, killer2;
     Move refutedMove; // needed to sort quiet moves by refutation history
+    bool isSkippingQuiets; // return only quiet moves that give check
+    QuietPruning skipReason;
 
     void PrepareNoisyList(Position* pos, MoveList& list, int& length, int& cnt);
+    bool IsBadNoisy(Position* pos, const Move move);
     bool IsAcceptableKiller(Position* pos, const Move killer);
+    void RemoveNonChecks(Position* pos);
 public:
     MovegenStage currentMoveStage; // read in search.cpp
-    void Init(const Mode mode, const Move ttMove, const Move firstKiller, const Move secondKiller, const Move refuted);
+    void Init(PickerLists* plyLists, const Mode mode, const Move ttMove, const Move firstKiller, const Move secondKiller, const Move refuted);
     Move NextMove(Position* pos);
+    void SkipQuiets(Position* pos, const QuietPruning reason);
 };
\ No newline at end of file
@@ -5,14 +5,19 @@
 #include "position.h"
 #include "move.h"
 #include "piece.h"
+#include "nn.h"
+#include "publius.h" // for VERIFY_NNUE
+#include "profiler.h"
 
 void Position::UndoMove(const Move move, UndoData* undo) {
 
+    PROFILE_SCOPE(profUndoMove);
+
     // Init variables
     const Color color = ~sideToMove;
     const Square fromSquare = GetFromSquare(move);
     const Square toSquare = GetToSquare(move);
-    const PieceType hunterType = TypeOfPiece(pieceLocation[toSquare]);
+    const PieceType hunterType = PieceTypeOnSq(toSquare);
     const int moveType = GetTypeOfMove(move);
 
     // Copy stuff needed to undo the move
@@ -21,7 +26,13 @@ void Position::UndoMove(const Move move, UndoData* undo) {
     reversibleMoves = undo->reversibleMoves;
     boardHash = undo->boardHash;
     pawnKingHash = undo->pawnHash;
-    repetitionIndex--;
+    repetitions->Pop();
+    pliesFromNull--;
+    RestoreCheckData(undo);
+
+#ifdef VERIFY_NNUE
+    ForgetMove();
+#endif
 
     // Move piece
     MovePieceNoHash(color, hunterType, toSquare, fromSquare);
@@ -62,7 +73,13 @@ void Position::UndoNull(UndoData* undo) {
 
     enPassantSq = undo->enPassantSq;
     boardHash = undo->boardHash;
-    repetitionIndex--;
+    repetitions->Pop();
+    RestoreCheckData(undo);
     reversibleMoves--;
+    pliesFromNull = undo->pliesFromNull;
     sideToMove = ~sideToMove;
+
+#ifdef VERIFY_NNUE
+    ForgetMove();
+#endif
 }
@@ -23,6 +23,7 @@
 
 #define __AVX2__
 
+#include <cstring>
 #include "types.h"
 #include "piece.h"
 #include "nn.h"
@@ -30,6 +31,12 @@
 
 #ifdef __AVX2__
 #include <immintrin.h>
+#endif
+
+#ifdef VERIFY_NNUE
+#include <chrono>
+#include <cstdlib>
+#include "move.h"
 #endif
 
     // Constructor
@@ -123,6 +130,7 @@
 
         // Rebuild accumulator from loaded biases
         this->Clear();
+        this->filePath = path;
 
         // Clear history and all the transposition tables
         OnNewGame();
@@ -134,6 +142,11 @@
     // Returns NNUE evaluation of position
     i32 Net::GetScore(i8 color) {
 
+#ifdef USE_RECORDERS
+        if (this->recorder)
+            this->recorder->push_back({ opScore, color, 0, 0, 0 });
+#endif
+
         i32 score = 0;
 
         score += SumHalfAccumulator(this->accumulator[color], PARAMS.outputWeights[0]);
@@ -165,6 +178,11 @@
         const auto indexWhite = Index(color, type, square);
         const auto indexBlack = Index(!color, type, square^56);
 
+#ifdef USE_RECORDERS
+        if (this->recorder)
+            this->recorder->push_back({ opAdd, color, type, square, 0 });
+#endif
+
 #if defined(__AVX2__)
 
         i16* __restrict a0 = &this->accumulator[0][0];
@@ -207,6 +225,11 @@
         const auto indexWhite = Index(color, type, square);
         const auto indexBlack = Index(!color, type, square^56);
 
+#ifdef USE_RECORDERS
+        if (this->recorder)
+            this->recorder->push_back({ opDel, color, type, square, 0 });
+#endif
+
 #if defined(__AVX2__)
 
         i16* __restrict a0 = &this->accumulator[0][0];
@@ -254,6 +277,11 @@
         SetIndices(color, type, addSq, addW, addB);
         SetIndices(color, type, subSq, subW, subB);
 
+#ifdef USE_RECORDERS
+        if (this->recorder)
+            this->recorder->push_back({ opMove, color, type, addSq, subSq });
+#endif
+
 #if defined(__AVX2__)
         i16* __restrict a0 = &this->accumulator[0][0];
         i16* __restrict a1 = &this->accumulator[1][0];
@@ -324,4 +352,79 @@
 
             this->Add(color, type, sq);
         }
-    }
\ No newline at end of file
+    }
+
+    // Compares incrementally updated accumulator with a fresh one,
+    // leaving the incremental state untouched
+    bool Net::IsInSync(Position& pos) {
+
+        alignas(64) i16 incremental[2][HIDDEN_SIZE];
+        std::vector<NetOp>* savedRecorder = this->recorder;
+
+        std::memcpy(incremental, this->accumulator, sizeof(incremental));
+        this->recorder = nullptr;
+        this->Refresh(pos);
+        this->recorder = savedRecorder;
+
+        const bool isInSync = std::memcmp(incremental, this->accumulator, sizeof(incremental)) == 0;
+        std::memcpy(this->accumulator, incremental, sizeof(incremental));
+        return isInSync;
+    }
+
+#ifdef VERIFY_NNUE
+
+    // Moves played since the last Position::Set(), null moves recorded as 0
+    static int moveHistory[4096];
+    static int moveHistoryLength = 0;
+
+    // Cost of verification
+    static size_t verificationCount = 0;
+    static long long verificationNs = 0;
+
+    void RememberMove(int move) {
+        if (moveHistoryLength < 4096)
+            moveHistory[moveHistoryLength] = move;
+        moveHistoryLength++;
+    }
+
+    void ForgetMove() {
+        moveHistoryLength--;
+    }
+
+    void ClearMoveHistory() {
+        moveHistoryLength = 0;
+    }
+
+    void VerifyAccumulator(Position& pos) {
+
+        using namespace std::chrono;
+        auto start = steady_clock::now();
+        const bool isInSync = NN.IsInSync(pos);
+        verificationNs += duration_cast<nanoseconds>(steady_clock::now() - start).count();
+        verificationCount++;
+
+        if (isInSync)
+            return;
+
+        std::cout << "NNUE accumulator out of sync after moves:";
+        for (int i = 0; i < std::min(moveHistoryLength, 4096); i++)
+            std::cout << " " << (moveHistory[i] ? MoveToString(moveHistory[i]) : "null");
+        std::cout << "\n";
+        PrintBoard(&pos);
+        std::abort();
+    }
+
+    void PrintVerificationCost(size_t timeUsed) {
+
+        const long long ms = verificationNs / 1000000;
+
+        std::cout << "NNUE verification: " << verificationCount << " checks, "
+                  << (verificationCount ? verificationNs / (long long)verificationCount : 0)
+                  << " ns per check, " << ms << " of " << timeUsed << " milliseconds\n"
+                  << std::flush;
+
+        verificationCount = 0;
+        verificationNs = 0;
+    }
+
+#endif
\ No newline at end of file
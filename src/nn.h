@@ -18,6 +18,8 @@
 
 #include <iostream>
 #include <algorithm>
+#include <string>
+#include <vector>
 #include "position.h"
 
 // int types
@@ -55,6 +57,20 @@ using i32 = int32_t;
 
     inline NNUEparameters PARAMS;
 
+    // Accumulator operations can be recorded during search
+    // and replayed later by the "nnbench" command. Recording
+    // is compiled in only with USE_RECORDERS (see publius.h).
+
+    enum NetOpType : i8 { opAdd, opDel, opMove, opScore };
+
+    struct NetOp {
+        i8 opType;
+        i8 color;
+        i8 type;
+        i8 square;
+        i8 fromSquare; // used only by opMove
+    };
+
     // Actual NNUE class
 
     class Net
@@ -62,6 +78,7 @@ using i32 = int32_t;
     private:
         alignas(64) i16 accumulator[2][HIDDEN_SIZE];
         int networkWidth = HIDDEN_SIZE; // assume we are loading the biggest net available
+        std::string filePath;           // where the current net was loaded from
         i32 SumHalfAccumulator(i16 inputs[HIDDEN_SIZE], i16 weights[HIDDEN_SIZE]);
     public:
         Net();
@@ -72,10 +89,24 @@ using i32 = int32_t;
         void Clear();
         void Refresh(Position& board);
         bool LoadFromFile(const char* path);
+        bool IsInSync(Position& pos);
+        int GetWidth() const { return networkWidth; }
+        const std::string& GetPath() const { return filePath; }
+        std::vector<NetOp>* recorder = nullptr; // set only by nnbench
     };
 
     extern Net NN;
 
+    // Accumulator verification, compiled in only with VERIFY_NNUE
+    // (see publius.h); callers wrap them in #ifdef, so that release
+    // builds don't pay for them. Move history is kept outside of
+    // Position, so that the flag doesn't change its layout.
+    void RememberMove(int move);
+    void ForgetMove();
+    void ClearMoveHistory();
+    void VerifyAccumulator(Position& pos);
+    void PrintVerificationCost(size_t timeUsed);
+
     // Calculating index to a neuron
     constexpr size_t Index(i8 color, i8 type, i8 square) {
 
@@ -0,0 +1,250 @@
+// Publius - Didactic public domain bitboard chess engine
+// by Pawel Koziol
+
+// NNUE micro-benchmark. Bench() measures whole searches,
+// where accumulator updates are drowned in everything else
+// the engine does. NnBench() times each Net kernel in
+// isolation, for every network file found in a directory,
+// and then replays the accumulator updates recorded during
+// a real search (only with USE_RECORDERS, see publius.h).
+// This way a slower kernel shows up here before it shows
+// up in match results.
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "types.h"
+#include "limits.h"
+#include "position.h"
+#include "bitboard.h"
+#include "nn.h"
+#include "timer.h"
+#include "search.h"
+#include "uci.h"
+#include "publius.h"
+
+// Number of calls used to time each kernel
+constexpr int kernelCalls = 1 << 20;
+
+// Random features used by the kernel loops,
+// so that we don't keep hitting the same
+// row of input weights
+struct Feature {
+    i8 color;
+    i8 type;
+    i8 square;
+};
+
+constexpr int featureCount = 1024;
+
+static std::vector<Feature> CreateFeatures() {
+
+    std::vector<Feature> features(featureCount);
+    unsigned int seed = 2018;
+
+    for (Feature& f : features) {
+        seed = seed * 1103515245 + 12345; // simple LCG is good enough here
+        f.color = (seed >> 16) & 1;
+        f.type = (seed >> 17) % 6;
+        f.square = (seed >> 20) & 63;
+    }
+    return features;
+}
+
+// Time a block of code, returning nanoseconds per call
+template <typename Kernel>
+static double NsPerCall(int calls, Kernel kernel) {
+
+    using namespace std::chrono;
+    auto start = steady_clock::now();
+    kernel();
+    auto stop = steady_clock::now();
+    return double(duration_cast<nanoseconds>(stop - start).count()) / calls;
+}
+
+// Effective bandwidth: bytes touched by a call divided by its duration
+static double GigabytesPerSecond(double bytesPerCall, double nsPerCall) {
+    return nsPerCall > 0 ? bytesPerCall / nsPerCall : 0;
+}
+
+static void PrintKernel(const char* name, double ns, double bytes) {
+
+    std::cout << "  " << std::left << std::setw(10) << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << ns << " ns/op"
+              << std::setw(10) << GigabytesPerSecond(bytes, ns) << " GB/s\n";
+}
+
+// Time Add, Del, Move, GetScore and Refresh with the currently loaded net
+static void BenchKernels(Position* pos, const std::vector<Feature>& features) {
+
+    const double row = double(NN.GetWidth()) * sizeof(i16); // one accumulator or weight row
+    volatile i32 sink = 0;
+    double ns;
+
+    // Add and Del read two weight rows and update two accumulator rows.
+    // Del undoes the Adds, so the accumulator is intact afterwards.
+    ns = NsPerCall(kernelCalls, [&] {
+        for (int i = 0; i < kernelCalls; i++) {
+            const Feature& f = features[i & (featureCount - 1)];
+            NN.Add(f.color, f.type, f.square);
+        }
+    });
+    PrintKernel("Add", ns, 6 * row);
+
+    ns = NsPerCall(kernelCalls, [&] {
+        for (int i = 0; i < kernelCalls; i++) {
+            const Feature& f = features[i & (featureCount - 1)];
+            NN.Del(f.color, f.type, f.square);
+        }
+    });
+    PrintKernel("Del", ns, 6 * row);
+
+    // Move reads four weight rows; we move a piece
+    // back and forth, so that the net stays intact
+    ns = NsPerCall(kernelCalls, [&] {
+        for (int i = 0; i < kernelCalls; i++) {
+            const Feature& f = features[i & (featureCount - 1)];
+            const i8 other = f.square ^ 9;
+            (i & 1) ? NN.Move(f.color, f.type, f.square, other)
+                    : NN.Move(f.color, f.type, other, f.square);
+        }
+    });
+    PrintKernel("Move", ns, 8 * row);
+
+    // GetScore reads both accumulators and both output weight rows
+    ns = NsPerCall(kernelCalls, [&] {
+        for (int i = 0; i < kernelCalls; i++)
+            sink = sink + NN.GetScore(i & 1);
+    });
+    PrintKernel("GetScore", ns, 4 * row);
+
+    // Refresh clears the accumulator and adds every piece
+    const int refreshCalls = kernelCalls / 32;
+    ns = NsPerCall(refreshCalls, [&] {
+        for (int i = 0; i < refreshCalls; i++)
+            NN.Refresh(*pos);
+    });
+    PrintKernel("Refresh", ns, (4 + 6 * PopCnt(pos->Occupied())) * row);
+}
+
+// Replay accumulator updates recorded from a search
+static void ReplayStream(Position* pos, const std::vector<NetOp>& stream) {
+
+    volatile i32 sink = 0;
+
+    if (stream.empty())
+        return;
+
+    // Short streams are replayed several times to get a stable timing.
+    // Search leaves the board as it found it, so each pass starts
+    // from the same accumulator.
+    const int passes = std::max(1, kernelCalls / (int)stream.size());
+    NN.Refresh(*pos);
+
+    const double ns = NsPerCall(passes * (int)stream.size(), [&] {
+        for (int pass = 0; pass < passes; pass++) {
+            for (const NetOp& op : stream) {
+                switch (op.opType) {
+                case opAdd: NN.Add(op.color, op.type, op.square); break;
+                case opDel: NN.Del(op.color, op.type, op.square); break;
+                case opMove: NN.Move(op.color, op.type, op.square, op.fromSquare); break;
+                case opScore: sink = sink + NN.GetScore(op.color); break;
+                }
+            }
+        }
+    });
+
+    std::cout << "  replay    " << std::fixed << std::setprecision(2)
+              << std::setw(10) << ns << " ns/op over "
+              << stream.size() << " recorded operations\n";
+}
+
+// Record accumulator updates made while searching the current position
+static void RecordStream(Position* pos, int depth, std::vector<NetOp>& stream) {
+
+#ifdef USE_RECORDERS
+    auto sc = std::make_unique<SearchContext>();
+    ClearSearchContext(*sc);
+
+    Timer.Start();
+    Timer.SetData(maxDepth, depth);
+    Timer.SetData(moveTime, 3600000);
+    Timer.SetData(isInfinite, 1);
+
+    OnNewGame();
+    NN.recorder = &stream;
+    Iterate(pos, sc.get());
+    NN.recorder = nullptr;
+    Timer.SetData(isInfinite, 0);
+#else
+    (void)pos;
+    (void)depth;
+    (void)stream;
+#endif
+}
+
+// Runs kernel benchmarks for all the nets in a directory,
+// then replays accumulator updates recorded from a search
+// of the current position to the given depth.
+void NnBench(Position* pos, int depth, const std::string& directory) {
+
+    const bool wasLoaded = isNNUEloaded;
+    const std::string originalPath = NN.GetPath();
+    const std::vector<Feature> features = CreateFeatures();
+    std::vector<std::string> nets;
+    std::vector<NetOp> stream;
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+        if (entry.path().extension() == ".bin")
+            nets.push_back(entry.path().string());
+
+    std::sort(nets.begin(), nets.end());
+
+    if (nets.empty()) {
+        std::cout << "info string no nets found in " << directory << "\n" << std::flush;
+        return;
+    }
+
+    // Record the update stream, using the net that was loaded
+    // (or the first one found, if we run on HCE)
+    if (!wasLoaded)
+        TryLoadingNNUE(nets[0].c_str());
+    NN.Refresh(*pos);
+    RecordStream(pos, depth, stream);
+
+#ifndef USE_RECORDERS
+    std::cout << "info string replay needs USE_RECORDERS (see publius.h)\n";
+#endif
+
+    for (const std::string& path : nets) {
+
+        if (!NN.LoadFromFile(path.c_str()))
+            continue;
+
+        isNNUEloaded = true;
+        NN.Refresh(*pos);
+
+        std::cout << path << " (width " << NN.GetWidth() << ")\n";
+        BenchKernels(pos, features);
+        ReplayStream(pos, stream);
+    }
+
+    // Restore the original net
+    if (wasLoaded)
+        TryLoadingNNUE(originalPath.c_str());
+    else
+        isNNUEloaded = false;
+
+    if (isNNUEloaded)
+        NN.Refresh(*pos);
+
+    std::cout << std::flush;
+}
@@ -0,0 +1,343 @@
+// Publius - Didactic public domain bitboard chess engine
+// by Pawel Koziol
+
+// Perft counts leaf nodes of a move tree of a given depth.
+// It measures move generation and board update speed, but
+// more importantly, it confirms that the move generator works
+// correctly. Results for many positions are well known, so
+// any discrepancy points to a bug.
+
+// To make deep perft runs practical, we use three tricks:
+// - bulk counting: at depth 1 we return the length of the
+//   legal move list instead of making each move
+// - perft hash table, storing subtree counts, because the
+//   same positions arise via different move orders
+// - root split: root moves are shared between threads,
+//   each thread working on its own copy of the position.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "types.h"
+#include "position.h"
+#include "movelist.h"
+#include "bitboard.h"
+#include "move.h"
+#include "legality.h"
+#include "gen.h"
+#include "nn.h"
+#include "publius.h"
+
+constexpr int perftHashMegabytes = 64;
+
+// Entry stores the hash key xored with data, so that
+// an entry torn by a write from another thread fails
+// verification instead of returning a wrong count.
+// Data packs the node count and the remaining depth.
+struct PerftEntry {
+    Bitboard key;
+    Bitboard data;
+};
+
+class PerftHash {
+private:
+    std::vector<PerftEntry> table;
+    Bitboard mask;
+public:
+    explicit PerftHash(int megabytes);
+    bool Probe(const Bitboard hash, const int depth, Bitboard* count) const;
+    void Save(const Bitboard hash, const int depth, const Bitboard count);
+};
+
+PerftHash::PerftHash(int megabytes) {
+
+    Bitboard size = 1;
+    while (2 * size * sizeof(PerftEntry) <= (Bitboard)megabytes << 20)
+        size *= 2;
+
+    table.assign(size, PerftEntry{ 0, 0 });
+    mask = size - 1;
+}
+
+bool PerftHash::Probe(const Bitboard hash, const int depth, Bitboard* count) const {
+
+    const PerftEntry& entry = table[hash & mask];
+    const Bitboard data = entry.data;
+
+    if ((entry.key ^ data) != hash || (data & 255) != (Bitboard)depth)
+        return false;
+
+    *count = data >> 8;
+    return true;
+}
+
+void PerftHash::Save(const Bitboard hash, const int depth, const Bitboard count) {
+
+    PerftEntry& entry = table[hash & mask];
+    const Bitboard data = (count << 8) | depth;
+
+    entry.key = hash ^ data;
+    entry.data = data;
+}
+
+// Fill the list with all the legal moves
+static void FillLegalList(Position* pos, MoveList* list) {
+
+    list->Clear();
+    FillNoisyList(pos, list, pos->GetCheckData());
+    FillQuietList(pos, list, pos->GetCheckData());
+}
+
+static Bitboard PerftRecursive(Position* pos, int depth, PerftHash* hash) {
+
+    MoveList list;
+    UndoData undo;
+    Move move;
+    Bitboard count = 0;
+
+    FillLegalList(pos, &list);
+
+#ifndef VERIFY_NNUE // we want to make the leaf moves
+    if (depth == 1)
+        return list.GetLength();
+#endif
+
+    if (hash && hash->Probe(pos->boardHash, depth, &count))
+        return count;
+
+    while ((move = list.GetNextRawMove()) != 0) {
+
+        pos->DoMove(move, &undo);
+
+#ifdef VERIFY_NNUE
+        if (isNNUEloaded)
+            VerifyAccumulator(*pos);
+#endif
+
+        count += (depth == 1) ? 1 : PerftRecursive(pos, depth - 1, hash);
+        pos->UndoMove(move, &undo);
+
+#ifdef VERIFY_NNUE
+        if (isNNUEloaded)
+            VerifyAccumulator(*pos);
+#endif
+    }
+
+    if (hash)
+        hash->Save(pos->boardHash, depth, count);
+
+    return count;
+}
+
+// Perft from a position, usable from a worker thread
+static Bitboard PerftCount(Position* pos, int depth, PerftHash* hash) {
+    return (depth < 1) ? 1 : PerftRecursive(pos, depth, hash);
+}
+
+// Runs perft, splitting root moves between threads.
+// With isNoisy flag set, it prints subtotals for each
+// root move ("divide"), which helps to locate a bug.
+Bitboard Perft(Position* pos, int depth, int threads, bool useHash, bool isNoisy) {
+
+    MoveList rootList;
+    Move move;
+    std::vector<Move> rootMoves;
+
+    if (depth < 1)
+        return 1;
+
+    FillLegalList(pos, &rootList);
+    while ((move = rootList.GetNextRawMove()) != 0)
+        rootMoves.push_back(move);
+
+    // Accumulator is shared, so threads must not update it.
+    // Verifying it requires updates, hence a single thread.
+    const bool wasLoaded = isNNUEloaded;
+#ifdef VERIFY_NNUE
+    threads = 1;
+    useHash = false;
+#else
+    isNNUEloaded = false;
+#endif
+
+    PerftHash* hash = (useHash && depth > 2) ? new PerftHash(perftHashMegabytes) : nullptr;
+    std::vector<Bitboard> counts(rootMoves.size(), 0);
+    std::atomic<int> nextMove(0);
+
+    auto worker = [&]() {
+
+        Position local = *pos;
+        RepetitionStack repetitions;
+        UndoData undo;
+        int index;
+
+        local.SetRepetitionStack(&repetitions);
+
+        while ((index = nextMove++) < (int)rootMoves.size()) {
+            local.DoMove(rootMoves[index], &undo);
+            counts[index] = (depth == 1) ? 1 : PerftRecursive(&local, depth - 1, hash);
+            local.UndoMove(rootMoves[index], &undo);
+        }
+    };
+
+    threads = std::max(1, std::min(threads, (int)rootMoves.size()));
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++)
+        pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool)
+        t.join();
+
+    delete hash;
+    isNNUEloaded = wasLoaded;
+
+    Bitboard total = 0;
+    for (size_t i = 0; i < rootMoves.size(); i++) {
+        total += counts[i];
+        if (isNoisy)
+            std::cout << MoveToString(rootMoves[i]) << ": " << counts[i] << "\n";
+    }
+
+    return total;
+}
+
+// Perft suite is a file in EPD-like format, where each
+// line holds a FEN followed by expected node counts:
+// "<fen> ;D1 20 ;D2 400 ;D3 8902"
+struct PerftTest {
+    Position pos;
+    std::vector<std::pair<int, Bitboard>> expected; // depth, nodes
+};
+
+static bool ParsePerftLine(const std::string& line, PerftTest* test) {
+
+    std::istringstream stream(line);
+    std::string fen, field;
+
+    if (!std::getline(stream, fen, ';') || fen.find('/') == std::string::npos)
+        return false;
+
+    while (std::getline(stream, field, ';')) {
+        std::istringstream fieldStream(field);
+        std::string depthToken;
+        Bitboard nodes;
+        if (fieldStream >> depthToken >> nodes && depthToken.size() > 1 && depthToken[0] == 'D')
+            test->expected.emplace_back(std::stoi(depthToken.substr(1)), nodes);
+    }
+
+    if (test->expected.empty())
+        return false;
+
+    test->pos.Set(fen);
+    return true;
+}
+
+// Runs all the tests from a perft suite file, up to maxDepth,
+// distributing positions between threads. Each thread works
+// on one position at a time, all of them sharing perft hash.
+void PerftSuite(Position* pos, const std::string& fileName, int maxDepth, int threads) {
+
+    std::ifstream file(fileName);
+    std::vector<PerftTest> tests;
+    std::string line;
+
+    if (!file) {
+        std::cout << "info string cannot open " << fileName << "\n" << std::flush;
+        return;
+    }
+
+    // Position::Set() refreshes the accumulator,
+    // so we set up all the positions in this thread
+    while (std::getline(file, line)) {
+        PerftTest test;
+        if (ParsePerftLine(line, &test))
+            tests.push_back(std::move(test));
+    }
+
+    const bool wasLoaded = isNNUEloaded;
+#ifdef VERIFY_NNUE
+    threads = 1;
+#else
+    isNNUEloaded = false;
+#endif
+
+    PerftHash hash(perftHashMegabytes);
+    std::atomic<int> nextTest(0);
+    std::atomic<int> failed(0);
+    std::atomic<Bitboard> totalNodes(0);
+    std::mutex outputLock;
+
+    auto worker = [&]() {
+
+        RepetitionStack repetitions;
+        int index;
+
+        while ((index = nextTest++) < (int)tests.size()) {
+
+            PerftTest& test = tests[index];
+            bool isPassed = true;
+
+            test.pos.SetRepetitionStack(&repetitions);
+
+            for (const auto& [depth, expected] : test.expected) {
+
+                if (depth > maxDepth)
+                    continue;
+
+#ifdef VERIFY_NNUE
+                // The accumulator now holds the last position
+                // searched; verification also skips the hash,
+                // so that all the leaf moves are made
+                if (isNNUEloaded)
+                    NN.Refresh(test.pos);
+                const Bitboard nodes = PerftCount(&test.pos, depth, nullptr);
+#else
+                const Bitboard nodes = PerftCount(&test.pos, depth, &hash);
+#endif
+                totalNodes += nodes;
+
+                if (nodes != expected) {
+                    isPassed = false;
+                    std::lock_guard<std::mutex> lock(outputLock);
+                    std::cout << "#" << index + 1 << " FAIL at depth " << depth
+                              << ": expected " << expected << ", got " << nodes << "\n";
+                    break;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(outputLock);
+            if (isPassed)
+                std::cout << "#" << index + 1 << " pass\n";
+            else
+                failed++;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    threads = std::max(1, std::min(threads, (int)tests.size()));
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++)
+        pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool)
+        t.join();
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    isNNUEloaded = wasLoaded;
+    if (isNNUEloaded)
+        NN.Refresh(*pos);
+
+    std::cout << "Perft suite: " << tests.size() - failed << " of " << tests.size()
+              << " positions passed, " << totalNodes << " nodes in " << (Bitboard)ms
+              << " milliseconds (" << totalNodes / (1000.0 * std::max(ms, 1.0))
+              << " Mnps)\n" << std::flush;
+}
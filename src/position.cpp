@@ -33,8 +33,12 @@ void Position::Clear() {
             pieceBitboard[color][pieceType] = 0ULL;
             pieceCount[color][pieceType] = 0;
         }
+
+        colorBitboard[color] = 0ULL;
     }
 
+    occupiedBitboard = 0ULL;
+
     // Clear piece locations
     for (Square square = A1; square < 64; ++square)
         pieceLocation[square] = noPiece;
@@ -42,7 +46,9 @@ void Position::Clear() {
     // Clear single variables
     castleFlags = 0;
     reversibleMoves = 0;
-    repetitionIndex = 0;
+    pliesFromNull = 0;
+    repetitions->index = 0;
+    isCheckDataValid = false;
     enPassantSq = sqNone;
     sideToMove = White;
 }
@@ -106,6 +112,10 @@ void Position::Set(const std::string& str) {
     boardHash = CalculateHashKey();
     pawnKingHash = CalculatePawnKingKey();
     NN.Refresh(*this);
+
+#ifdef VERIFY_NNUE
+    ClearMoveHistory();
+#endif
 }
 
 void Position::TrySettingEp(char numberChar, Square whiteSq, Square blackSq) {
@@ -164,9 +174,11 @@ void Position::MovePiece(const Color color, const PieceType pieceType,
 void Position::MovePieceNoHash(const Color color, const PieceType pieceType,
     const Square fromSquare, Square toSquare) {
 
+    pieceLocation[toSquare] = pieceLocation[fromSquare];
     pieceLocation[fromSquare] = noPiece;
-    pieceLocation[toSquare] = CreatePiece(color, pieceType);
     pieceBitboard[color][pieceType] ^= Paint(fromSquare, toSquare);
+    colorBitboard[color] ^= Paint(fromSquare, toSquare);
+    occupiedBitboard ^= Paint(fromSquare, toSquare);
 
     if (isNNUEloaded)
         NN.Move(color, pieceType, toSquare, fromSquare);
@@ -186,6 +198,8 @@ void Position::TakePieceNoHash(const Color color,
 
     pieceLocation[square] = noPiece;
     pieceBitboard[color][pieceType] ^= Paint(square);
+    colorBitboard[color] ^= Paint(square);
+    occupiedBitboard ^= Paint(square);
     pieceCount[color][pieceType]--;
 
     if (isNNUEloaded)
@@ -198,6 +212,8 @@ void Position::AddPieceNoHash(const Color color,
 
     pieceLocation[square] = CreatePiece(color, pieceType);
     pieceBitboard[color][pieceType] ^= Paint(square);
+    colorBitboard[color] ^= Paint(square);
+    occupiedBitboard ^= Paint(square);
     pieceCount[color][pieceType]++;
 
     if (isNNUEloaded)
@@ -209,6 +225,7 @@ void Position::ChangePieceNoHash(const PieceType oldType,
     const Color color,
     const Square square) {
 
+    // color and occupancy maps stay the same
     pieceLocation[square] = CreatePiece(color, newType);
     pieceBitboard[color][oldType] ^= Paint(square);
     pieceBitboard[color][newType] ^= Paint(square);
@@ -237,10 +254,27 @@ void Position::UpdateCastlingRights(const Square fromSquare, const Square toSqua
     boardHash ^= Key.castleKey[castleFlags];
 }
 
+// Check data is copied only if it has been calculated,
+// and it's invalidated for the child node
+void Position::SaveCheckData(UndoData* undo) {
+
+    undo->isCheckDataValid = isCheckDataValid;
+    if (isCheckDataValid)
+        undo->checkData = checkData;
+    isCheckDataValid = false;
+}
+
+void Position::RestoreCheckData(const UndoData* undo) {
+
+    isCheckDataValid = undo->isCheckDataValid;
+    if (isCheckDataValid)
+        checkData = undo->checkData;
+}
+
 void Position::TryMarkingIrreversible() {
 
     if (reversibleMoves == 0)
-        repetitionIndex = 0;
+        repetitions->index = 0;
 }
 
 std::tuple<Color, PieceType> PieceFromChar(char c) {
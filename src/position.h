@@ -2,8 +2,34 @@
 // by Pawel Koziol
 
 #pragma once
+#include <cstdint>
 #include <string>
 
+// Check and pin information, calculated lazily once per node
+// (see Position::GetCheckData()) and reused by the legal move
+// generator, legality tests and MoveGivesCheck().
+// A move of a piece other than king must land on checkMask,
+// which covers the whole board if we are not in check,
+// checker and squares between it and the king in case
+// of a single check, and nothing in case of a double check.
+// Pinned pieces must also stay on the line connecting them
+// with the king. Discoverers are our pieces standing alone
+// between our slider and the enemy king, so that moving
+// them off that line gives a discovered check.
+
+struct CheckData {
+    Square kingSq;
+    Square enemyKingSq;
+    Bitboard checkers;
+    Bitboard pinned;
+    Bitboard discoverers;
+    Bitboard checkMask;
+    Bitboard checkSquares[6]; // piece of this type placed there checks enemy king
+};
+
+class Position;
+void SetCheckData(const Position* pos, CheckData* cd);
+
 // data for undoing a move
 
 typedef struct {
@@ -12,10 +38,32 @@ typedef struct {
     int castleFlags;
     Square enPassantSq;
     int reversibleMoves;
+    int pliesFromNull; // saved only by DoNull()
     Bitboard boardHash;
     Bitboard pawnHash;
+    bool isCheckDataValid;
+    CheckData checkData; // saved only if valid
 } UndoData;
 
+// Hash keys of positions reached since the last irreversible
+// move, used for repetition detection. The stack is kept outside
+// of Position, so that Position itself stays small and cheap
+// to copy. The position played in the game uses GameRepetitions;
+// other positions (test suites, benchmarks) default to a scratch
+// stack, so that setting them up cannot clear the game history.
+// A thread working on its own copy must give it its own stack.
+
+struct RepetitionStack {
+    Bitboard list[1024];
+    int index = 0;
+
+    void Push(const Bitboard key) { list[index++] = key; }
+    void Pop() { index--; }
+};
+
+extern RepetitionStack GameRepetitions;
+extern RepetitionStack ScratchRepetitions;
+
 // Position class: stores the board state, makes 
 // and unmakes moves, provides information about 
 // the current position.
@@ -26,16 +74,22 @@ typedef struct {
 class Position {
 private:
     // --- Core state ---
-    Color sideToMove;
+    // (ordered by size and using small types, so that
+    // the whole object spans only a few cache lines)
     Bitboard pieceBitboard[2][6];
+    Bitboard colorBitboard[2]; // updated together with pieceBitboard
+    Bitboard occupiedBitboard;
+    Color sideToMove;
     Square kingSq[2];
     Square enPassantSq;
     int castleFlags;
-    int pieceCount[2][6];
-    ColoredPiece pieceLocation[64];
     int reversibleMoves;
-    int repetitionIndex;
-    Bitboard repetitionList[256];
+    int pliesFromNull; // repetition scans must not cross a null move
+    std::uint8_t pieceCount[2][6];
+    std::uint8_t pieceLocation[64]; // ColoredPiece
+    RepetitionStack* repetitions = &ScratchRepetitions;
+    mutable CheckData checkData; // see GetCheckData()
+    mutable bool isCheckDataValid;
 
     // --- Internal helpers (not for public use) ---
     void Clear();
@@ -48,6 +102,8 @@ private:
     void ChangePieceNoHash(PieceType oldType, PieceType newType, Color color, Square sq);
     void SetEnPassantSquare(Color color, Square to);
     void UpdateCastlingRights(Square from, Square to);
+    void SaveCheckData(UndoData* undo);
+    void RestoreCheckData(const UndoData* undo);
     Bitboard CalculateHashKey();
     Bitboard CalculatePawnKingKey();
     [[nodiscard]] bool IsDrawByRepetition() const;
@@ -67,9 +123,11 @@ public:
     void UndoMove(Move move, UndoData* undo);
     void UndoNull(UndoData* undo);
     void TryMarkingIrreversible();
+    void SetRepetitionStack(RepetitionStack* stack) { repetitions = stack; }
 
     // --- Game state queries ---
     [[nodiscard]] bool IsDraw() const;
+    [[nodiscard]] bool IsUpcomingRepetition() const;
     [[nodiscard]] bool CanTryNullMove() const;
     [[nodiscard]] bool IsInCheck() const;
     [[nodiscard]] bool IsOwnKingInCheck() const; // illegal position
@@ -99,13 +157,19 @@ public:
     [[nodiscard]] Bitboard Map(Color color, PieceType piece) const {
         return pieceBitboard[color][piece];
     }
-    [[nodiscard]] Bitboard Pieces(Color color) const;
+    [[nodiscard]] Bitboard Pieces(Color color) const {
+        return colorBitboard[color];
+    }
+    [[nodiscard]] Bitboard Occupied() const {
+        return occupiedBitboard;
+    }
+    [[nodiscard]] Bitboard Empty() const {
+        return ~occupiedBitboard;
+    }
     [[nodiscard]] Bitboard MapDiagonalSliders(Color color) const;
     [[nodiscard]] Bitboard MapStraightSliders(Color color) const;
     [[nodiscard]] Bitboard AllDiagMovers() const;
     [[nodiscard]] Bitboard AllStraightMovers() const;
-    [[nodiscard]] Bitboard Occupied() const;
-    [[nodiscard]] Bitboard Empty() const;
     [[nodiscard]] Bitboard MapPieceType(const PieceType pieceType) const {
         return pieceBitboard[White][pieceType] |
                pieceBitboard[Black][pieceType];
@@ -118,9 +182,21 @@ public:
     [[nodiscard]] Bitboard AttacksFrom(Square sq) const;
     [[nodiscard]] bool MoveGivesCheck(Move move);
 
+    // --- Check and pin information ---
+    // Calculated on the first request in a node. DoMove() saves
+    // it in UndoData and UndoMove() restores it, so that search
+    // doesn't recalculate it after returning from each child.
+    [[nodiscard]] const CheckData* GetCheckData() const {
+        if (!isCheckDataValid) {
+            SetCheckData(this, &checkData);
+            isCheckDataValid = true;
+        }
+        return &checkData;
+    }
+
     // --- Basic getters (fast, inline) ---
     [[nodiscard]] Color GetSideToMove() const { return sideToMove; }
-    [[nodiscard]] ColoredPiece GetPiece(Square sq) const { return pieceLocation[sq]; }
+    [[nodiscard]] ColoredPiece GetPiece(Square sq) const { return ColoredPiece(pieceLocation[sq]); }
     [[nodiscard]] bool IsOccupied(Square sq) const { return pieceLocation[sq] != noPiece; }
     [[nodiscard]] Square KingSq(Color color) const { return kingSq[color]; }
     [[nodiscard]] Square EnPassantSq() const { return enPassantSq; }
@@ -10,6 +10,7 @@
 #include "bitboard.h"
 #include "bitgen.h"
 #include "move.h"
+#include "mask.h"
 
 bool Position::EitherSquareIsAttacked(const Square s1, const Square s2, const Color color) const {
     return SquareIsAttacked(s1, color) || SquareIsAttacked(s2, color);
@@ -42,7 +43,7 @@ Bitboard Position::AttacksFrom(const Square sq) const {
 
     switch (PieceTypeOnSq(sq)) {
     case Pawn:
-        return GenerateMoves.Pawn(ColorOfPiece(pieceLocation[sq]), sq);
+        return GenerateMoves.Pawn(ColorOfPiece(GetPiece(sq)), sq);
     case Knight:
         return GenerateMoves.Knight(sq);
     case Bishop:
@@ -61,118 +62,96 @@ Bitboard Position::AttacksFrom(const Square sq) const {
 // without making it on the board
 bool Position::MoveGivesCheck(const Move move) {
 
-    Bitboard checks, occ;
+    // Check squares and discovered check candidates
+    // are calculated once per node
+    const CheckData* cd = GetCheckData();
 
     // Collect information about the move
     const MoveDescription md(*this, move);
 
-    // What piece is placed on the destination square?
-    PieceType placedPiece = IsMovePromotion(move) ? GetPromotedPiece(move) : md.hunter;
-
-    // Locate enemy king
-    Square kingSquare = KingSq(~md.side);
-
-    // Direct checks by a pawn
-    if (placedPiece == Pawn) {
-        checks = ForwardOf(SidesOf(Paint(kingSquare)), ~md.side);
-        if (checks & Paint(md.toSquare)) return true;
+    // Horizontal checks discovered by castling
+    // (we make and unmake a move, as it's rare enough
+    // and writing out correct conditions would be hard)
+    if (md.type == tCastle) {
+        UndoData undo;
+        DoMove(move, &undo);
+        bool isInCheck = IsInCheck();
+        UndoMove(move, &undo);
+        return isInCheck;
     }
 
-    // Init occupancy bitboard
-    occ = Occupied();
+    // Direct checks
+    if (IsMovePromotion(move)) {
 
-    // Remove pawn in case of promotion,
-    // otherwise we will not detect checks
-    // along the same ray as the promoting move
-    if (IsMovePromotion(move))
-        occ ^= Paint(md.fromSquare);
+        // Remove pawn in case of promotion, otherwise
+        // we will not detect checks along the same ray
+        // as the promoting move
+        const Bitboard occ = Occupied() ^ Paint(md.fromSquare);
+        const Square kingSquare = cd->enemyKingSq;
+        Bitboard checks = 0;
 
-    // Direct checks by a knight
-    if (placedPiece == Knight) {
-        checks = GenerateMoves.Knight(kingSquare);
-        if (checks & Paint(md.toSquare)) return true;
-    }
-
-    // Direct diagonal checks
-    if (placedPiece == Bishop || placedPiece == Queen) {
-        checks = GenerateMoves.Bish(occ, kingSquare);
-        if (checks & Paint(md.toSquare)) return true;
-    }
+        switch (GetPromotedPiece(move)) {
+            case Knight: checks = GenerateMoves.Knight(kingSquare); break;
+            case Bishop: checks = GenerateMoves.Bish(occ, kingSquare); break;
+            case Rook:   checks = GenerateMoves.Rook(occ, kingSquare); break;
+            case Queen:  checks = GenerateMoves.Queen(occ, kingSquare); break;
+            default: break;
+        }
 
-    // Direct orthogonal checks
-    if (placedPiece == Rook || placedPiece == Queen) {
-        checks = GenerateMoves.Rook(occ, kingSquare);
         if (checks & Paint(md.toSquare)) return true;
-    }
-
-    // Prepare occupancy map after the move...
-    occ = Occupied() ^ Paint(md.fromSquare, md.toSquare);
-
-    // ...remembering to take captures into account
-    if (md.prey != noPieceType)
-        occ ^= Paint(md.toSquare);
 
-    // Diagonal discovered checks
-    checks = GenerateMoves.Bish(occ, kingSquare);
-    if (checks & MapDiagonalSliders(md.side)) return true;
+    } else if (cd->checkSquares[md.hunter] & Paint(md.toSquare))
+        return true;
 
-    // Orthogonal discovered checks
-    checks = GenerateMoves.Rook(occ, kingSquare);
-    if (checks & MapStraightSliders(md.side)) return true;
+    // Discovered checks: a piece leaves the line
+    // between our slider and the enemy king
+    if ((cd->discoverers & Paint(md.fromSquare)) &&
+        !(Mask.line[cd->enemyKingSq][md.fromSquare] & Paint(md.toSquare)))
+        return true;
 
     // Checks discovered by en passant capture
-    if (GetTypeOfMove(move) == tEnPassant) {
-        int dir = (GetSideToMove() == White ? -8 : 8);
-        occ ^= Paint(md.toSquare + dir);
+    // (captured pawn may have been the blocker)
+    if (md.type == tEnPassant) {
+        const Bitboard occ = Occupied() ^ Paint(md.fromSquare, md.toSquare, md.toSquare ^ 8);
 
-        checks = GenerateMoves.Bish(occ, kingSquare);
-        if (checks & MapDiagonalSliders(md.side)) return true;
-
-        checks = GenerateMoves.Rook(occ, kingSquare);
-        if (checks & MapStraightSliders(md.side)) return true;
-    }
-
-    // Horizontal checks discovered by castling
-    // (we make and unmake a move, as it's rare enough
-    // and writing out correct conditions would be hard)
-    if (GetTypeOfMove(move) == tCastle) {
-        UndoData undo;
-        DoMove(move, &undo);
-        bool isInCheck = IsInCheck();
-        UndoMove(move, &undo);
-        return isInCheck;
+        if (GenerateMoves.Bish(occ, cd->enemyKingSq) & MapDiagonalSliders(md.side)) return true;
+        if (GenerateMoves.Rook(occ, cd->enemyKingSq) & MapStraightSliders(md.side)) return true;
     }
 
     return false;
 }
 
-// Detect castle legality (we are not testing
-// for a check on king's destination square
-// because search will handle that case)
+// Detect castle legality, including a check
+// on king's destination square, so that
+// castling moves are fully legal
 bool Position::IsWhiteShortCastleLegal() {
 
     return ((castleFlags & wShortCastle) &&
            !(Occupied() & Paint(F1, G1)) &&
-           !EitherSquareIsAttacked(E1, F1, Black));
+           !EitherSquareIsAttacked(E1, F1, Black) &&
+           !SquareIsAttacked(G1, Black));
 }
 
 bool Position::IsWhiteLongCastleLegal() {
 
     return ((castleFlags & wLongCastle) &&
            !(Occupied() & Paint(B1, C1, D1)) &&
-           !EitherSquareIsAttacked(E1, D1, Black));
+           !EitherSquareIsAttacked(E1, D1, Black) &&
+           !SquareIsAttacked(C1, Black));
 }
 
 bool Position::IsBlackShortCastleLegal() {
 
     return ((castleFlags & bShortCastle) &&
            !(Occupied() & Paint(F8, G8)) &&
-           !EitherSquareIsAttacked(E8, F8, White));
+           !EitherSquareIsAttacked(E8, F8, White) &&
+           !SquareIsAttacked(G8, White));
 }
 
 bool Position::IsBlackLongCastleLegal() {
 
     return ((castleFlags & bLongCastle) &&
            !(Occupied() & Paint(B8, C8, D8)) &&
-           !EitherSquareIsAttacked(E8, D8, White));
+           !EitherSquareIsAttacked(E8, D8, White) &&
+           !SquareIsAttacked(C8, White));
 }
\ No newline at end of file
@@ -10,23 +10,10 @@
 #include "piece.h"
 #include "position.h"
 #include "bitboard.h"
-
-// Map squares occupied by pieces (including pawns) of a given color
-Bitboard Position::Pieces(const Color color) const {
-
-    return Map(color, Pawn) | Map(color, Knight) | Map(color, Bishop)
-         | Map(color, Rook) | Map(color, Queen) | Map(color, King);
-}
-
-// Map occupied squares
-Bitboard Position::Occupied() const {
-    return Pieces(White) | Pieces(Black);
-}
-
-// Map empty squares
-Bitboard Position::Empty() const {
-    return ~Occupied();
-}
+#include "move.h"
+#include "mask.h"
+#include "hashkeys.h"
+#include <algorithm>
 
 // Map pieces of a given color that move diagonally
 Bitboard Position::MapDiagonalSliders(const Color color) const {
@@ -41,7 +28,7 @@ Bitboard Position::MapStraightSliders(const Color color) const {
 
 // Get type of the piece occupying given square
 PieceType Position::PieceTypeOnSq(const Square square) const {
-    return TypeOfPiece(pieceLocation[square]);
+    return TypeOfPiece(ColoredPiece(pieceLocation[square]));
 }
 
 // Map pieces that move diagonally (both colors)
@@ -75,8 +62,47 @@ bool Position::IsDraw() const {
 // Detect draw by repetition
 bool Position::IsDrawByRepetition() const {
 
-    for (int i = 4; i <= reversibleMoves; i += 2) {
-        if (boardHash == repetitionList[repetitionIndex - i])
+    const int end = std::min(reversibleMoves, repetitions->index);
+
+    for (int i = 4; i <= end; i += 2) {
+        if (boardHash == repetitions->list[repetitions->index - i])
+            return true;
+    }
+
+    return false;
+}
+
+// Can side to move repeat an earlier position in a single
+// move? Hash key difference between the current position
+// and the earlier one must be a key of a reversible move,
+// found in the cuckoo table (see HashKeys::InitCuckoo()).
+// Only positions with the other side to move qualify, so
+// we step by two plies, stopping at the last irreversible
+// move or null move. The move also needs a clear path
+// and has to be made by a piece of the side to move.
+bool Position::IsUpcomingRepetition() const {
+
+    const int end = std::min({ reversibleMoves, pliesFromNull, repetitions->index });
+
+    for (int i = 3; i <= end; i += 2) {
+
+        const Bitboard moveKey = boardHash ^ repetitions->list[repetitions->index - i];
+        int slot = CuckooSlot1(moveKey);
+
+        if (Key.cuckooKey[slot] != moveKey) {
+            slot = CuckooSlot2(moveKey);
+            if (Key.cuckooKey[slot] != moveKey)
+                continue;
+        }
+
+        const Square fromSquare = GetFromSquare(Key.cuckooMove[slot]);
+        const Square toSquare = GetToSquare(Key.cuckooMove[slot]);
+
+        if (Mask.between[fromSquare][toSquare] & occupiedBitboard)
+            continue;
+
+        const Square pieceSquare = IsOccupied(fromSquare) ? fromSquare : toSquare;
+        if (ColorOfPiece(GetPiece(pieceSquare)) == sideToMove)
             return true;
     }
 
@@ -96,7 +122,13 @@ bool Position::IsDrawByInsufficientMaterial() const {
 }
 
 // Is side to move in check?
+// (cached checkers are used if available, but we don't
+// calculate the whole CheckData just to answer this)
 bool Position::IsInCheck() const {
+
+    if (isCheckDataValid)
+        return checkData.checkers != 0;
+
     return SquareIsAttacked(KingSq(sideToMove), ~sideToMove);
 }
 
@@ -0,0 +1,108 @@
+// Publius - Didactic public domain bitboard chess engine
+// by Pawel Koziol
+
+// Collecting and reporting hot path timings (see profiler.h)
+
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+#include "types.h"
+#include "position.h"
+#include "publius.h"
+#include "profiler.h"
+
+#ifdef USE_PROFILER
+
+static const char* slotNames[profSlotCount] = {
+    "Evaluate", "EvalNN", "EvalHCE", "FillNoisyList", "FillQuietList", "FillCheckList",
+    "SeeGe", "DoMove", "UndoMove", "TT.Retrieve", "TT.Store", "History updates" };
+
+static std::mutex profileMutex;
+static std::vector<ProfileData*> liveProfiles;  // threads still running
+static uint64_t finishedCycles[profSlotCount];  // sum of finished threads
+static uint64_t finishedCalls[profSlotCount];
+static uint64_t profileStart;
+
+thread_local ProfileData threadProfile;
+
+ProfileData::ProfileData() {
+
+    Clear();
+
+    std::lock_guard<std::mutex> lock(profileMutex);
+    liveProfiles.push_back(this);
+}
+
+ProfileData::~ProfileData() {
+
+    std::lock_guard<std::mutex> lock(profileMutex);
+
+    for (int slot = 0; slot < profSlotCount; slot++) {
+        finishedCycles[slot] += cycles[slot];
+        finishedCalls[slot] += calls[slot];
+    }
+
+    for (size_t i = 0; i < liveProfiles.size(); i++) {
+        if (liveProfiles[i] == this) {
+            liveProfiles.erase(liveProfiles.begin() + i);
+            break;
+        }
+    }
+}
+
+void ProfileData::Clear(void) {
+
+    for (int slot = 0; slot < profSlotCount; slot++)
+        cycles[slot] = calls[slot] = 0;
+}
+
+// Must not be called while other threads are working
+void ResetProfile(void) {
+
+    std::lock_guard<std::mutex> lock(profileMutex);
+
+    for (ProfileData* data : liveProfiles)
+        data->Clear();
+
+    for (int slot = 0; slot < profSlotCount; slot++)
+        finishedCycles[slot] = finishedCalls[slot] = 0;
+
+    profileStart = __rdtsc();
+}
+
+void PrintProfile(void) {
+
+    const uint64_t total = __rdtsc() - profileStart;
+    uint64_t cycles[profSlotCount], calls[profSlotCount];
+
+    {
+        std::lock_guard<std::mutex> lock(profileMutex);
+
+        for (int slot = 0; slot < profSlotCount; slot++) {
+            cycles[slot] = finishedCycles[slot];
+            calls[slot] = finishedCalls[slot];
+            for (const ProfileData* data : liveProfiles) {
+                cycles[slot] += data->cycles[slot];
+                calls[slot] += data->calls[slot];
+            }
+        }
+    }
+
+    std::cout << "Profile (" << total << " cycles in total):\n"
+              << std::left << std::setw(18) << "function"
+              << std::right << std::setw(14) << "calls"
+              << std::setw(16) << "cycles/call"
+              << std::setw(10) << "share" << "\n";
+
+    for (int slot = 0; slot < profSlotCount; slot++) {
+        std::cout << std::left << std::setw(18) << slotNames[slot]
+                  << std::right << std::setw(14) << calls[slot]
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(16) << (calls[slot] ? double(cycles[slot]) / calls[slot] : 0.0)
+                  << std::setw(9) << (total ? 100.0 * cycles[slot] / total : 0.0) << "%\n";
+    }
+    std::cout << std::flush;
+}
+
+#endif
@@ -0,0 +1,72 @@
+// Publius - Didactic public domain bitboard chess engine
+// by Pawel Koziol
+
+#pragma once
+
+// Hot path profiler, compiled in only with USE_PROFILER (see
+// publius.h, which must be included before this header).
+// PROFILE_SCOPE(slot) placed at the top of a function starts
+// a timer that reads the CPU time stamp counter and adds the
+// elapsed cycles to the slot when the function returns. Each
+// thread accumulates its own data, so timers don't contend.
+// Bench resets the data and prints cycles per call and share
+// of the total time. Slots may nest (Evaluate() contains
+// EvalNN() and EvalHCE()), so shares don't add up to 100%.
+// Without USE_PROFILER, PROFILE_SCOPE() expands to nothing.
+
+#ifdef USE_PROFILER
+
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+enum ProfileSlot {
+    profEvaluate,
+    profEvalNN,
+    profEvalHCE,
+    profNoisyGen,
+    profQuietGen,
+    profCheckGen,
+    profSee,
+    profDoMove,
+    profUndoMove,
+    profTTRetrieve,
+    profTTStore,
+    profHistory,
+    profSlotCount };
+
+struct ProfileData {
+    uint64_t cycles[profSlotCount];
+    uint64_t calls[profSlotCount];
+    ProfileData();  // registers thread's data for reporting
+    ~ProfileData(); // keeps the results of a finished thread
+    void Clear(void);
+};
+
+extern thread_local ProfileData threadProfile;
+
+class ScopedTimer {
+private:
+    ProfileSlot slot;
+    uint64_t start;
+public:
+    explicit ScopedTimer(const ProfileSlot profileSlot) : slot(profileSlot), start(__rdtsc()) {}
+    ~ScopedTimer() {
+        threadProfile.cycles[slot] += __rdtsc() - start;
+        threadProfile.calls[slot]++;
+    }
+};
+
+void ResetProfile(void);
+void PrintProfile(void);
+
+#define PROFILE_SCOPE(slot) ScopedTimer scopedTimer(slot)
+
+#else
+
+#define PROFILE_SCOPE(slot)
+
+#endif
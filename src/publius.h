@@ -12,6 +12,33 @@
 
 //#define USE_TUNING
 
+//#define USE_SEARCH_STATS
+// counts how often each pruning, reduction and extension
+// technique fires (see searchstats.h and "searchstats"
+// command). Cheap, but keep it off in release builds.
+
+//#define USE_PROFILER
+// times hot functions (evaluation, move generation, SEE,
+// making moves, transposition table, history) with a cycle
+// counter and reports them after bench (see profiler.h).
+// x86 only; keep it off in release builds.
+
+//#define USE_RECORDERS
+// lets "nnbench" and "sortbench" record the accumulator updates
+// and the scored move lists of a real search and replay them.
+// Recording adds a branch to hot functions, so keep it off
+// in release builds.
+
+//#define VERIFY_NNUE
+// debug mode: every evaluation (and every perft node) compares
+// the incrementally updated NNUE accumulator with a fresh one,
+// aborting with the move history if they differ. Very slow.
+
+//#define USE_PEXT
+// compiles PEXT sliding attack generator (setoption name
+// SliderAttacks value pext). Needs a CPU supporting BMI2;
+// on some older AMD CPUs PEXT is slow and magics are faster.
+
 // REGEX to count all the lines under MSVC 13: ^(?([^\r\n])\s)*[^\s+?/]+[^\n]*$
 // 4462 lines of source code
 
@@ -58,12 +85,19 @@ extern int multiPv;
 // entry points
 
 void UciLoop(void);
+void RunCommandLine(int argc, char* argv[]);
 void OnNewGame(void);
 void Think(Position* pos);
 
 // diagnostics
 
-void Bench(Position* pos, int depth);
+void Bench(Position* pos, int depth, int repeats, const std::string& fileName, int threads, bool asJson);
+void NnBench(Position* pos, int depth, const std::string& directory);
+void GenBench(int depth);
+void SortBench(Position* pos, int depth);
+void EvalBench(Position* pos, const std::string& fileName);
+void EpdSuite(Position* pos, const std::string& fileName, const std::string& budgetName, size_t limit);
 void PrintBoard(Position* pos);
-Bitboard Perft(Position* pos, int ply, int depth, bool isNoisy);
+Bitboard Perft(Position* pos, int depth, int threads, bool useHash, bool isNoisy);
+void PerftSuite(Position* pos, const std::string& fileName, int maxDepth, int threads);
 void PrintBitboard(Bitboard b);
\ No newline at end of file
@@ -13,15 +13,20 @@
 #include "timer.h"
 #include "history.h"
 #include "badcapture.h"
+#include "legality.h"
 #include "movepicker.h"
+#include "capturepicker.h"
+#include "publius.h"
+#include "searchstats.h"
 
-int Quiesce(Position* pos, int ply, int qdepth, int alpha, int beta) {
+int Quiesce(Position* pos, SearchContext* context, int ply, int qdepth, int alpha, int beta) {
 
     int bestScore, hashFlag, score;
     Move move, bestMove, ttMove;
     EvalData e;
     UndoData undo;
     MovePicker movePicker;
+    CapturePicker capturePicker;
     bool saveInTT = true;
 
     // Init
@@ -33,6 +38,7 @@ int Quiesce(Position* pos, int ply, int qdepth, int alpha, int beta) {
 
     // Statistics
     Timer.nodeCount++;
+    CountStat(statQsNodes);
 
     // Check for timeout
     TryInterrupting();
@@ -45,8 +51,10 @@ int Quiesce(Position* pos, int ply, int qdepth, int alpha, int beta) {
     // (in zero window nodes or when we get exact score)
     if (TT.Retrieve(pos->boardHash, &ttMove, &score, &hashFlag, alpha, beta, 0, ply)) {
 
-        if (!isPv || (score > alpha && score < beta))
+        if (!isPv || (score > alpha && score < beta)) {
+            CountStat(statTtCuts);
             return score;
+        }
     }
 
     Pv.size[ply] = ply;
@@ -61,7 +69,7 @@ int Quiesce(Position* pos, int ply, int qdepth, int alpha, int beta) {
 
     // Safeguarding against ply limit overflow
     if (ply >= SearchTreeSize - 1)
-        return Evaluate(pos, &e);
+        return Evaluate(pos, &e, alpha, beta);
 
     // Are we in check? Then we must flee
     const bool isInCheck = pos->IsInCheck();
@@ -69,7 +77,7 @@ int Quiesce(Position* pos, int ply, int qdepth, int alpha, int beta) {
     // Get a stand-pat score and adjust bounds
     // (exiting if eval exceeds beta, but starting
     // with minus infinity when in check)
-    bestScore = isInCheck ? -Infinity : Evaluate(pos, &e);
+    bestScore = isInCheck ? -Infinity : Evaluate(pos, &e, alpha, beta);
 
     // Static score cutoff
     if (bestScore >= beta)
@@ -96,22 +104,25 @@ int Quiesce(Position* pos, int ply, int qdepth, int alpha, int beta) {
         saveInTT = false;
     }
 
-    movePicker.Init(movegenMode, ttMove,
-                    History.GetKiller1(ply), 
-                    History.GetKiller2(ply), 0);
+    // Captures-only nodes are the most numerous,
+    // so they get a dedicated, lighter move picker
+    const bool isCaptureOnly = (movegenMode == modeCaptures);
 
-    while ((move = movePicker.NextMove(pos)) != 0) {
+    if (isCaptureOnly)
+        capturePicker.Init(ttMove);
+    else
+        movePicker.Init(&context->lists[ply], movegenMode, ttMove,
+                        History.GetKiller1(ply), 
+                        History.GetKiller2(ply), 0);
 
-        // Make move, unless illegal
-        pos->DoMove(move, &undo);
+    while ((move = isCaptureOnly ? capturePicker.NextMove(pos) 
+                                 : movePicker.NextMove(pos)) != 0) {
 
-        if (pos->IsOwnKingInCheck()) {
-            pos->UndoMove(move, &undo);
-                continue;
-        }
+        // Make move (MovePicker returns only legal moves)
+        pos->DoMove(move, &undo);
 
         // Recursion
-        score = -Quiesce(pos, ply + 1, qdepth + 1, -beta, -alpha);
+        score = -Quiesce(pos, context, ply + 1, qdepth + 1, -beta, -alpha);
 
         // Unmake move
         pos->UndoMove(move, &undo);
@@ -2,6 +2,7 @@
 // by Pawel Koziol
 
 #include <iostream>
+#include <memory>
 #include "types.h"
 #include "limits.h"
 #include "position.h"
@@ -13,22 +14,25 @@
 #include "search.h"
 #include "trans.h"
 #include "publius.h"
+#include "searchstats.h"
 
 ExcludedMoves rootExclusions;
+std::vector<IterationInfo>* iterationRecorder = nullptr;
 
 void Think(Position* pos) {
 
-    SearchContext context;
+    auto context = std::make_unique<SearchContext>();
 
     // Init
-    ClearSearchContext(context);
+    ClearSearchContext(*context);
     Pv.Clear();
     History.ClearOnNewSearch();
+    Stats.Clear();
     TT.Age();
     Timer.Start();
 
     // Search, increasing depth, until stopped.
-    Iterate(pos, &context);
+    Iterate(pos, context.get());
 
     // In ultra-rare cases we don't get a move because  the 
     // time  control is too short or we got a stop  command. 
@@ -46,7 +50,7 @@ void OverwriteFromTT(Position *pos)
     
     TT.Retrieve(pos->boardHash, &move, &unused, &unused, -Infinity, Infinity, 0, 0);
     
-    if (IsPseudoLegal(pos, move))
+    if (IsPseudoLegal(pos, move) && IsLegal(pos, pos->GetCheckData(), move))
         Pv.Overwrite(move);
 }
 
@@ -73,6 +77,9 @@ void Iterate(Position* pos, SearchContext* context) {
         else
             curVal = MultiPv(pos, context, Timer.rootDepth);
 
+        if (iterationRecorder && !Timer.isStopping)
+            iterationRecorder->push_back({ Timer.rootDepth, Timer.Elapsed(), Timer.nodeCount, Pv.GetBestMove() });
+
         // Stop searching when we are sure of a checkmate score
         // (the engine is given some depth to confirm that it
         //  cannot find a shorter checkmate)
@@ -194,6 +201,8 @@ int Widen(Position* pos, SearchContext* context, int depth, int lastScore) {
                 // alpha stays
             }
 
+            CountStat(statAspirationResearches);
+
             // verify a checkmate by searching with infinite bounds
             if (currentDepthScore > EvalLimit)
                 break;
@@ -17,15 +17,16 @@
 #include "evaldata.h"
 #include "api.h"
 #include "uci.h"
+#include "legality.h"
 #include "movepicker.h"
 #include "util.h"
 #include "publius.h"
+#include "searchstats.h"
 #include "search.h"
 
 Move bestRootMove = 0; // 3157245
 
 const int singularDepth = 7;
-static const Move noPreviousMove = CreateMove(A8, C1, 0);
 static const Stack rootSentinel{/*capture target=*/-1, /*eval=*/0, /*move*/ noPreviousMove};
 
 int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta, int depth, bool wasNullMove, bool isExcluded) {
@@ -36,7 +37,7 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
     EvalData e;
     UndoData undo;
     MovePicker movePicker;
-    Move listOfTriedMoves[256];
+    Move* listOfTriedMoves = context->triedMoves[ply];
     bool singularExtension;
 
     // Init
@@ -75,10 +76,11 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
     // bringing depth down below zero.
 
     if (depth <= 0)
-        return Quiesce(pos, ply, 0, alpha, beta);
+        return Quiesce(pos, context, ply, 0, alpha, beta);
 
     // Some bookkeeping
     Timer.nodeCount++;
+    CountStat(statNodes);
     Pv.size[ply] = ply;
 
     // Periodically check for timeout, 
@@ -98,6 +100,19 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
         return ScoreDraw;
     }
 
+    // UPCOMING REPETITION: if we can repeat an earlier
+    // position in one move, we are guaranteed at least
+    // a draw, so alpha can be raised to the draw score.
+    // This cuts a lot of shuffling in drawn endgames.
+
+    if (!isRoot && alpha < ScoreDraw && pos->IsUpcomingRepetition()) {
+        alpha = ScoreDraw;
+        if (alpha >= beta) {
+            Timer.TryStopping();
+            return alpha;
+        }
+    }
+
     // MATE DISTANCE PRUNING, a minor improvement shaving 
     // off some nodes when the checkmate is near. It pre-
     // vents looking for the longer checkmates if a shorter 
@@ -134,14 +149,16 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
         // same nominal depth, they represent more shallow, 
         // less precise search.
         if (!isPv || (score > alpha && score < beta)) {
-            if (!isRoot && !isExcluded)
+            if (!isRoot && !isExcluded) {
+                CountStat(statTtCuts);
                 return score;
+            }
         }
     }
 
     // Safeguard against ply limit overflow
     if (ply >= SearchTreeSize - 1)
-        return Evaluate(pos, &e);
+        return Evaluate(pos, &e, alpha, beta);
 
     // Prepare for singular extension
     if (!isRoot &&                  // we are not at the root
@@ -168,7 +185,7 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
     // interesting and warrant more pruning.
 
     // Evaluate position, unless in check
-    eval = isInCheckBeforeMoving ? -Infinity : Evaluate(pos, &e);
+    eval = isInCheckBeforeMoving ? -Infinity : Evaluate(pos, &e, alpha, beta);
 
     // Adjust  node  eval by using score from  the  trans-
     // position table. It modifies a few things, including
@@ -209,8 +226,10 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
 
         if (depth <= 6) {
             score = eval - 135 * depth;
-            if (score > beta)
+            if (score > beta) {
+                CountStat(statRfpCuts);
                 return score;
+            }
         }
 
         // RAZORING - we drop directly to the quiescence
@@ -218,13 +237,19 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
 
         if (depth <= 3 && eval + 200 * depth < beta) {
 
-            if (depth <= 1 && eval + 600 < alpha)
-                return Quiesce(pos, ply, 0, alpha, beta);
+            CountStat(statRazorTried);
+
+            if (depth <= 1 && eval + 600 < alpha) {
+                CountStat(statRazorCuts);
+                return Quiesce(pos, context, ply, 0, alpha, beta);
+            }
 
-            score = Quiesce(pos, ply, 0, alpha, beta);
+            score = Quiesce(pos, context, ply, 0, alpha, beta);
 
-            if (score < beta) // no fail high!
+            if (score < beta) { // no fail high!
+                CountStat(statRazorCuts);
                 return score;
+            }
             if (Timer.isStopping)
                 return 0;
         }
@@ -246,6 +271,7 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
 
             // Set null move reduction
             reduction = 4 + depth / 6 + (eval - beta > 200);
+            CountStat(statNullTried);
 
             // Do null move search, giving the opponent
             // two moves in a row
@@ -261,14 +287,18 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
             // we  verify null move search with a normal 
             // reduced  depth  search to  guard  against 
             // zugzwangs (~10 Elo)
-            if (depth - reduction > 5 && score >= beta)
+            if (depth - reduction > 5 && score >= beta) {
+                CountStat(statNullVerified);
                 score = Search(pos, context, ply, alpha, beta, depth - reduction - 4, true, false);
+            }
 
             if (Timer.isStopping)
                 return 0;
 
-            if (score >= beta)
+            if (score >= beta) {
+                CountStat(statNullCuts);
                 return score;
+            }
         }   // end of null move code
     } // end of node pruning block
 
@@ -284,6 +314,9 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
         !isPv &&
         eval + 75 * depth < beta);
 
+    if (canDoFutility)
+        CountStat(statFutilityNodes);
+
     // INTERNAL ITERATIVE REDUCTION  (non-standard). Reduce
     // when position is not on transposition table. An idea
     // from Prodeo chess engine (by Ed Schroder). Note that 
@@ -291,8 +324,10 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
     // pv-nodes  are not excluded, but this is what  worked 
     // for this engine. (~9 Elo)
 
-    if (depth > 5 && !isPv && ttMove == 0 && !isInCheckBeforeMoving)
+    if (depth > 5 && !isPv && ttMove == 0 && !isInCheckBeforeMoving) {
+        CountStat(statIirReductions);
         depth--;
+    }
 
     // Init moves and variables before entering main loop
     bestScore = -Infinity;
@@ -301,7 +336,7 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
     // the  transposition  table is  our  first  candidate, 
     // except at  root, where we begin with the best  move  
     // from previous iteration.
-    movePicker.Init(modeAll,
+    movePicker.Init(&context->lists[ply], modeAll,
                     isRoot ? Pv.line[0][0] : ttMove,
                     History.GetKiller1(ply),
                     History.GetKiller2(ply),
@@ -337,12 +372,16 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
 
         // Check extension
         bool doExtension = moveGivesCheck && (isPv || depth < 4);
+        if (doExtension)
+            CountStat(statCheckExtensions);
 
         // Recapture extension - pv node or low depth (~28 Elo)
         if (ply && !doExtension) {
             if (onePlyAgo.captureSquare == GetToSquare(move) &&
-                (isPv || depth < 7))
+                (isPv || depth < 7)) {
+                CountStat(statRecaptureExtensions);
                 doExtension = true;
+            }
         }
 
         // Singular extension: tried once per search
@@ -362,6 +401,7 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
             // We  are looking for decent alternatives, so
             // we  do not try the singular move  candidate.
             context->excludedMove = move;
+            CountStat(statSingularTried);
 
             // The only time we search with isExcluded flag 
             // set  to  "true". The flag switches  off  all
@@ -382,19 +422,16 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
             // so  we extend. The search result relies on 
             // the  single move - it would be a shame  if 
             // a deeper search revealed a refutation.
-            if (exclusionSearchScore <= newAlpha)
+            if (exclusionSearchScore <= newAlpha) {
+                CountStat(statSingularExtensions);
                 doExtension = true;
+            }
         } // end of singular extension code
 
         // Check basic conditions for pruning a move
         bool canPruneMove = !isPv && !isInCheckBeforeMoving &&
             !moveGivesCheck && movePicker.currentMoveStage == stageReturnQuiet;
 
-        // FUTILITY PRUNING
-        // (~2 Elo, so definately needs tuning)
-        if (canDoFutility && movesTried > 0 && canPruneMove)
-            continue;
-
         // LATE MOVE PRUNING. At low  depths  quiet  moves
         // near  the end of the move list are unlikely  to
         // succeed, so we prune them. This may lead to  an
@@ -406,6 +443,8 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
             canPruneMove &&
             quietMovesTried > ((3 + improving) * depth) - 1)
         {
+            CountStat(statLmpNodes);
+            movePicker.SkipQuiets(pos, pruneLateMove); // the rest would be pruned too
             continue;
         }
 
@@ -419,18 +458,18 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
         //    alpha > -MateScore + 500 &&
         //    movesTried > 1) 
         //{
-        //    if (Swap(pos, GetFromSquare(move), GetToSquare(move)) < -25 * depth * depth)
+        //    if (!SeeGe(pos, move, -25 * depth * depth))
         //        continue;
         //}
 
-        // Make move
-        pos->DoMove(move, &undo);
+        // FUTILITY PRUNING. We are about to try a move, so
+        // from now on MovePicker returns only quiet moves
+        // that give check. (~2 Elo, so definitely needs tuning)
+        if (canDoFutility)
+            movePicker.SkipQuiets(pos, pruneFutility);
 
-        // Filter out illegal moves
-        if (pos->IsOwnKingInCheck()) {
-            pos->UndoMove(move, &undo);
-            continue;
-        }
+        // Make move (MovePicker returns only legal moves)
+        pos->DoMove(move, &undo);
 
         // Update move statistics
         listOfTriedMoves[movesTried] = move;
@@ -475,6 +514,7 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
 
             // do a reduced depth search
             if (reduction > 0) {
+                CountStat(statLmrTried);
                 score = -Search(pos, context, ply + 1, -alpha - 1, -alpha, newDepth - reduction, false, false);
 
                 // If  the reduced search score falls  below
@@ -485,6 +525,7 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
                         return 0;
                     continue;
                 }
+                CountStat(statLmrResearches);
             }
         }
 
@@ -501,8 +542,10 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
             score = -Search(pos, context, ply + 1, -beta, -alpha, newDepth, false, false);
         else {
             score = -Search(pos, context, ply + 1, -alpha - 1, -alpha, newDepth, false, false);
-            if (!Timer.isStopping && score > alpha)
+            if (!Timer.isStopping && score > alpha) {
+                CountStat(statPvsResearches);
                 score = -Search(pos, context, ply + 1, -beta, -alpha, newDepth, false, false);
+            }
         }
 
         // Undo move
@@ -514,6 +557,10 @@ int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta,
         // Beta cutoff
         if (score >= beta) {
 
+            CountStat(statBetaCuts);
+            if (movesTried == 1)
+                CountStat(statFirstMoveCuts);
+
             // Beta cutoff means that a move is good. We update
             // history table and killer moves for quiet moves 
             // that caused a cutoff, so that such moves will be 
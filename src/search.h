@@ -4,6 +4,8 @@
 #pragma once
 
 #include "move.h"
+#include "movelist.h"
+#include "movepicker.h"
 #include <vector>
 #include <string>
 #include <iostream>
@@ -16,9 +18,14 @@ struct Stack {
     Move move;         // move made at current ply
 };
 
-// SearchContext holds data generated and passed around during search
+// SearchContext holds data generated and passed around during search.
+// Move lists and tried moves form a per-ply arena, so that they
+// don't weigh down the stack frames of Search() and Quiesce().
+// It is large, so it is allocated on the heap.
 struct SearchContext {
 	Stack stack[SearchTreeSize];
+	PickerLists lists[SearchTreeSize];
+	Move triedMoves[SearchTreeSize][MoveListSize];
 	Move excludedMove;
 };
 
@@ -119,12 +126,22 @@ struct MultiPVLines {
 
 extern ExcludedMoves rootExclusions;
 
+// Data of a completed iteration, recorded for epdsuite
+struct IterationInfo {
+    int depth;
+    size_t time;
+    size_t nodes;
+    Move bestMove;
+};
+
+extern std::vector<IterationInfo>* iterationRecorder; // set only by epdsuite
+
 void ClearSearchContext(SearchContext& context);
 void Iterate(Position* pos, SearchContext* context);
 int MultiPv(Position* pos, SearchContext* context, int depth);
 int Widen(Position* pos, SearchContext* context, int depth, int lastScore);
 int Search(Position* pos, SearchContext* context, int ply, int alpha, int beta, int depth, bool wasNullMove, bool isExcluded);
-int Quiesce(Position* pos, int ply, int qdepth, int alpha, int beta);
+int Quiesce(Position* pos, SearchContext* context, int ply, int qdepth, int alpha, int beta);
 bool SetImproving(const Stack &ppst, int eval, int ply);
 void PrintRootInfo();
 void TryInterrupting(void);
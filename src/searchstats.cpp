@@ -0,0 +1,109 @@
+// Publius - Didactic public domain bitboard chess engine
+// by Pawel Koziol
+
+// Reporting search statistics (see searchstats.h). Each counter
+// is printed together with its rate relative to a base counter,
+// e.g. null move cutoffs as a fraction of null move searches.
+
+#include <iostream>
+#include <iomanip>
+#include "types.h"
+#include "position.h"
+#include "publius.h"
+#include "searchstats.h"
+
+SearchStats Stats;
+
+struct StatInfo {
+    SearchStat stat;
+    SearchStat base; // statCount if there is no sensible base
+    const char* name;
+    const char* key; // JSON field
+};
+
+static const StatInfo statInfo[statCount] = {
+    { statNodes,                statCount,         "main nodes",             "nodes" },
+    { statQsNodes,              statNodes,         "quiescence nodes",       "qs_nodes" },
+    { statTtProbes,             statCount,         "tt probes",              "tt_probes" },
+    { statTtHits,               statTtProbes,      "tt hits",                "tt_hits" },
+    { statTtCuts,               statTtProbes,      "tt cutoffs",             "tt_cuts" },
+    { statRfpCuts,              statNodes,         "static null cutoffs",    "rfp_cuts" },
+    { statRazorTried,           statNodes,         "razoring tried",         "razor_tried" },
+    { statRazorCuts,            statRazorTried,    "razoring cutoffs",       "razor_cuts" },
+    { statNullTried,            statNodes,         "null move tried",        "null_tried" },
+    { statNullVerified,         statNullTried,     "null move verified",     "null_verified" },
+    { statNullCuts,             statNullTried,     "null move cutoffs",      "null_cuts" },
+    { statFutilityNodes,        statNodes,         "futility nodes",         "futility_nodes" },
+    { statFutilityPrunes,       statFutilityNodes, "futility prunes",        "futility_prunes" },
+    { statLmpNodes,             statNodes,         "late move pruning",      "lmp_nodes" },
+    { statLmpPrunes,            statLmpNodes,      "late move prunes",       "lmp_prunes" },
+    { statIirReductions,        statNodes,         "iir reductions",         "iir" },
+    { statLmrTried,             statNodes,         "lmr searches",           "lmr_tried" },
+    { statLmrResearches,        statLmrTried,      "lmr re-searches",        "lmr_researches" },
+    { statPvsResearches,        statNodes,         "pvs re-searches",        "pvs_researches" },
+    { statCheckExtensions,      statNodes,         "check extensions",       "check_extensions" },
+    { statRecaptureExtensions,  statNodes,         "recapture extensions",   "recapture_extensions" },
+    { statSingularTried,        statNodes,         "singular searches",      "singular_tried" },
+    { statSingularExtensions,   statSingularTried, "singular extensions",    "singular_extensions" },
+    { statBetaCuts,             statNodes,         "beta cutoffs",           "beta_cuts" },
+    { statFirstMoveCuts,        statBetaCuts,      "first move cutoffs",     "first_move_cuts" },
+    { statAspirationResearches, statCount,         "aspiration re-searches", "aspiration_researches" },
+};
+
+void SearchStats::Clear(void) {
+
+    for (int i = 0; i < statCount; i++)
+        count[i] = 0;
+}
+
+static double Rate(const size_t* count, const StatInfo& info) {
+
+    const size_t base = count[info.base];
+    return base ? double(count[info.stat]) / base : 0.0;
+}
+
+// Counters and rates as a single JSON object
+void SearchStats::WriteJson(std::ostream& out) {
+
+    out << "{\"counters\": {";
+    for (int i = 0; i < statCount; i++)
+        out << (i ? ", " : "") << "\"" << statInfo[i].key << "\": " << count[i];
+
+    out << "}, \"rates\": {" << std::fixed << std::setprecision(4);
+    bool isFirst = true;
+    for (const StatInfo& info : statInfo) {
+        if (info.base == statCount)
+            continue;
+        out << (isFirst ? "" : ", ") << "\"" << info.key << "\": " << Rate(count, info);
+        isFirst = false;
+    }
+    out << "}}";
+}
+
+void SearchStats::Print(bool asJson) {
+
+#ifndef USE_SEARCH_STATS
+    (void)asJson;
+    std::cout << "Search statistics are not compiled in (see USE_SEARCH_STATS in publius.h)\n" << std::flush;
+#else
+    if (asJson) {
+        WriteJson(std::cout);
+        std::cout << "\n" << std::flush;
+        return;
+    }
+
+    std::cout << "Search statistics:\n";
+
+    for (const StatInfo& info : statInfo) {
+        std::cout << std::left << std::setw(24) << info.name
+                  << std::right << std::setw(14) << count[info.stat];
+
+        if (info.base != statCount)
+            std::cout << std::fixed << std::setprecision(2) << std::setw(10)
+                      << Rate(count, info) * 100 << "% of " << statInfo[info.base].name;
+
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+#endif
+}
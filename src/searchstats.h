@@ -0,0 +1,61 @@
+// Publius - Didactic public domain bitboard chess engine
+// by Pawel Koziol
+
+#pragma once
+
+#include <ostream>
+
+// Search statistics: how often each pruning, reduction and
+// extension technique fires, so that tuning them can be driven
+// by data. Counters are compiled in only with USE_SEARCH_STATS
+// (see publius.h, which must be included before this header);
+// otherwise CountStat() is empty and costs nothing. They are
+// cleared at the start of each search and of each bench, and
+// shown by "searchstats [json]" and at the end of bench.
+
+enum SearchStat {
+    statNodes,                // main search nodes
+    statQsNodes,              // quiescence search nodes
+    statTtProbes,             // transposition table lookups
+    statTtHits,               // ...that found the position
+    statTtCuts,               // ...whose score ended the search of a node
+    statRfpCuts,              // static null move (reverse futility) cutoffs
+    statRazorTried,           // razoring quiescence searches
+    statRazorCuts,            // ...that confirmed a fail low
+    statNullTried,            // null move searches
+    statNullVerified,         // ...that needed a verification search
+    statNullCuts,             // ...that ended with a cutoff
+    statFutilityNodes,        // nodes where futility pruning was enabled
+    statFutilityPrunes,       // quiet moves skipped there by futility pruning
+    statLmpNodes,             // nodes where late move pruning began
+    statLmpPrunes,            // quiet moves skipped there by late move pruning
+    statIirReductions,        // internal iterative reductions
+    statLmrTried,             // late move reductions
+    statLmrResearches,        // ...which failed high and were re-searched
+    statPvsResearches,        // zero window searches re-searched with a full window
+    statCheckExtensions,      // check extensions
+    statRecaptureExtensions,  // recapture extensions
+    statSingularTried,        // singular searches
+    statSingularExtensions,   // ...that extended the move from TT
+    statBetaCuts,             // beta cutoffs in the main search
+    statFirstMoveCuts,        // ...caused by the first move tried
+    statAspirationResearches, // root re-searches after failing an aspiration window
+    statCount };
+
+struct SearchStats {
+    size_t count[statCount];
+    void Clear(void);
+    void Print(bool asJson);
+    void WriteJson(std::ostream& out);
+};
+
+extern SearchStats Stats;
+
+inline void CountStat(const SearchStat stat, const size_t amount = 1) {
+#ifdef USE_SEARCH_STATS
+    Stats.count[stat] += amount;
+#else
+    (void)stat;
+    (void)amount;
+#endif
+}
@@ -0,0 +1,185 @@
+// Publius - Didactic public domain bitboard chess engine
+// by Pawel Koziol
+
+// Move ordering micro-benchmark. MoveList used to pick
+// the best move with a linear scan at each call, which
+// is cheap if the first move causes a cutoff, but costs
+// O(n^2) if all the moves are searched. Sorting the list
+// after scoring has the opposite trade-off, so now the
+// first move is picked by a scan and the rest is sorted
+// only when needed (see MoveList::GetBestMove()).
+// SortBench() records scored lists from a real search
+// (only with USE_RECORDERS, see publius.h) and times all
+// three methods on them, picking only the first move and
+// picking all the moves.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+#include "types.h"
+#include "limits.h"
+#include "position.h"
+#include "timer.h"
+#include "search.h"
+#include "uci.h"
+#include "publius.h"
+
+typedef std::vector<std::vector<MoveEntry>> ListBank;
+
+enum PickMethod { pickSelection, pickSort, pickPartial, pickMethodCount };
+
+static const char* pickNames[pickMethodCount] = { "selection", "sort", "partial" };
+
+// Number of times each recorded list is replayed
+constexpr int replayRounds = 8;
+
+// The old method: find the best remaining entry,
+// and swap it to the front of the remaining ones
+static MoveEntry SelectBest(MoveEntry* entries, int get, int ind) {
+
+    MoveEntry score = 0;
+    int loc = get;
+
+    for (int i = get; i < ind; i++) {
+        if ((entries[i] >> moveBits) > score) {
+            score = entries[i] >> moveBits;
+            loc = i;
+        }
+    }
+
+    const MoveEntry best = entries[loc];
+    entries[loc] = entries[get];
+    entries[get] = best;
+    return best;
+}
+
+// Nanoseconds per list needed to pick "picks" moves
+// (or all the moves, if the list is shorter)
+static double TimePicking(const ListBank& bank, int picks, PickMethod method, MoveEntry& checksum) {
+
+    MoveEntry entries[MoveListSize];
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int round = 0; round < replayRounds; round++) {
+        for (const std::vector<MoveEntry>& list : bank) {
+
+            const int length = (int)list.size();
+            const int last = std::min(picks, length);
+            std::copy(list.begin(), list.end(), entries);
+
+            if (method == pickSelection) {
+                for (int i = 0; i < last; i++)
+                    checksum += SelectBest(entries, i, length) * (i + 1);
+                continue;
+            }
+
+            if (method == pickSort)
+                SortEntries(entries, entries + length);
+            else if (length > 0) {
+                MoveBestToFront(entries, entries + length);
+                if (last > 1)
+                    SortEntries(entries + 1, entries + length);
+            }
+
+            for (int i = 0; i < last; i++)
+                checksum += entries[i] * (i + 1);
+        }
+    }
+
+    const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start).count());
+
+    return ns / (double(replayRounds) * std::max<size_t>(bank.size(), 1));
+}
+
+// Both methods must produce the same sequence of scores.
+// Moves with equal scores may come in a different order.
+static bool OrdersAgree(const ListBank& bank) {
+
+    MoveEntry selected[MoveListSize];
+    MoveEntry sorted[MoveListSize];
+
+    for (const std::vector<MoveEntry>& list : bank) {
+
+        const int length = (int)list.size();
+        std::copy(list.begin(), list.end(), selected);
+        std::copy(list.begin(), list.end(), sorted);
+        SortEntries(sorted, sorted + length);
+
+        for (int i = 0; i < length; i++)
+            if ((SelectBest(selected, i, length) >> moveBits) != (sorted[i] >> moveBits))
+                return false;
+    }
+
+    return true;
+}
+
+// Record move lists scored while searching the current position
+static void RecordLists(Position* pos, int depth, ListBank& bank) {
+
+#ifdef USE_RECORDERS
+    auto sc = std::make_unique<SearchContext>();
+    ClearSearchContext(*sc);
+
+    Timer.Start();
+    Timer.SetData(maxDepth, depth);
+    Timer.SetData(moveTime, 3600000);
+    Timer.SetData(isInfinite, 1);
+
+    OnNewGame();
+    MoveList::recorder = &bank;
+    Iterate(pos, sc.get());
+    MoveList::recorder = nullptr;
+    Timer.SetData(isInfinite, 0);
+#else
+    (void)pos;
+    (void)depth;
+    (void)bank;
+#endif
+}
+
+void SortBench(Position* pos, int depth) {
+
+    ListBank bank;
+    MoveEntry checksum = 0;
+    size_t moves = 0;
+
+    RecordLists(pos, depth, bank);
+
+#ifndef USE_RECORDERS
+    std::cout << "info string recording lists needs USE_RECORDERS (see publius.h)\n";
+#endif
+
+    for (const std::vector<MoveEntry>& list : bank)
+        moves += list.size();
+
+    std::cout << bank.size() << " lists recorded, "
+              << std::fixed << std::setprecision(2)
+              << (bank.empty() ? 0.0 : double(moves) / bank.size())
+              << " moves per list on average\n";
+
+    // Warm up
+    TimePicking(bank, MoveListSize, pickSelection, checksum);
+
+    std::cout << std::left << std::setw(14) << "method"
+              << std::right << std::setw(14) << "first ns"
+              << std::setw(14) << "all ns" << "\n";
+
+    for (int method = pickSelection; method < pickMethodCount; method++) {
+
+        const double firstNs = TimePicking(bank, 1, (PickMethod)method, checksum);
+        const double allNs = TimePicking(bank, MoveListSize, (PickMethod)method, checksum);
+
+        std::cout << std::left << std::setw(14) << pickNames[method]
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << firstNs
+                  << std::setw(14) << allNs << "\n";
+    }
+
+    std::cout << "score order " << (OrdersAgree(bank) ? "agrees" : "DIFFERS")
+              << " (checksum " << checksum % 1000 << ")\n" << std::flush;
+}
@@ -5,6 +5,9 @@
 #include "limits.h"
 #include "position.h"
 #include "trans.h"
+#include "publius.h"
+#include "searchstats.h"
+#include "profiler.h"
 
 // Transposition table remembers results
 // of the previous searches. If the engine
@@ -52,10 +55,13 @@ void TransTable::Age(void) {
 
 bool TransTable::Retrieve(Bitboard key, Move* move, int* score, int* flag, int alpha, int beta, int depth, int ply) {
 
+    PROFILE_SCOPE(profTTRetrieve);
+
     hashRecord *slot;
 
     // Find the first slot eligible for holding relevant data
     slot = FindFirstSlot(key);
+    CountStat(statTtProbes);
 
     // Look at a couple of slots where information
     // related to the current position might be saved
@@ -63,6 +69,7 @@ bool TransTable::Retrieve(Bitboard key, Move* move, int* score, int* flag, int a
        
         // Make sure hash entry describes current board position
         if (slot->key == key) {
+            CountStat(statTtHits);
 
             // We don't know yet if score can be reused,
             // but move can come handy for sorting purposes
@@ -88,6 +95,8 @@ bool TransTable::Retrieve(Bitboard key, Move* move, int* score, int* flag, int a
 
 void TransTable::Store(Bitboard key, Move move, int score, int flags, int depth, int ply) {
 
+    PROFILE_SCOPE(profTTStore);
+
     hashRecord *slot;
     hashRecord* replace = NULL;
     int oldest, age;
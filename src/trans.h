@@ -10,7 +10,7 @@ enum eHashEntry { None, upperBound, lowerBound, exactEntry };
 
 typedef struct {
     Bitboard key;
-    short move;
+    Move move;
     short score;
     short date;
     unsigned char flags;
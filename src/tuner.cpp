@@ -3,6 +3,7 @@
 #include <cmath>
 #include <iostream> // for cout
 #include "types.h"
+#include "limits.h"
 #include "square.h"
 #include "position.h"
 #include "publius.h" // for USE_TUNING
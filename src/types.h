@@ -4,9 +4,10 @@
 // Defining basic types and operators applied to them
 
 #pragma once
+#include <cstdint>
 
 typedef unsigned long long Bitboard;
-typedef int Move;
+typedef std::uint16_t Move; // flag << 12 | to << 6 | from
 
 // ---------- Color ----------
 // https://github.com/nescitus/publius/wiki/Color
@@ -3,9 +3,13 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <cctype>
 #include <climits>
 #include <iostream>
 #include <sstream>
+#include <thread>
+#include <vector>
 #include "types.h"
 #include "limits.h"
 #include "position.h"
@@ -23,6 +27,8 @@
 #include "api.h"
 #include "eval.h"
 #include "nn.h"
+#include "bitgen.h"
+#include "searchstats.h"
 
 #ifdef USE_TUNING
    cTuner Tuner;
@@ -34,6 +40,7 @@
        std::cin.tie(nullptr);
 
        Position pos[1];
+       pos->SetRepetitionStack(&GameRepetitions);
        pos->Set(startFen);
        TT.Allocate(16);
 
@@ -45,6 +52,23 @@
        }
    }
 
+// Runs a single command given on the command line,
+// e.g. "publius bench 13 json", for scripts and CI
+void RunCommandLine(int argc, char* argv[]) {
+
+    Position pos[1];
+    pos->SetRepetitionStack(&GameRepetitions);
+    pos->Set(startFen);
+    TT.Allocate(16);
+
+    std::string line;
+    for (int i = 1; i < argc; i++)
+        line += std::string(argv[i]) + " ";
+
+    std::istringstream ss(line);
+    ParseCommand(ss, pos);
+}
+
 bool ParseCommand(std::istringstream& stream, Position* pos) {
 
     std::string command;
@@ -58,7 +82,14 @@ bool ParseCommand(std::istringstream& stream, Position* pos) {
     else if (command == "setoption") OnSetOptionCommand(stream);
     else if (command == "print") PrintBoard(pos);
     else if (command == "perft") OnPerftCommand(stream, pos);
+    else if (command == "perftsuite") OnPerftSuiteCommand(stream, pos);
     else if (command == "bench") OnBenchCommand(stream, pos);
+    else if (command == "nnbench") OnNnBenchCommand(stream, pos);
+    else if (command == "genbench") OnGenBenchCommand(stream);
+    else if (command == "sortbench") OnSortBenchCommand(stream, pos);
+    else if (command == "searchstats") OnSearchStatsCommand(stream);
+    else if (command == "epdsuite") OnEpdSuiteCommand(stream, pos);
+    else if (command == "evalbench") OnEvalBenchCommand(stream, pos);
     else if (command == "step") OnStepCommand(stream, pos);
     else if (command == "stop") OnStopCommand();
 #ifdef USE_TUNING
@@ -85,12 +116,42 @@ void OnUciCommand() {
     std::cout << "option name NNUEfile type string default " << netPath << "\n";
     std::cout << "option name nnueWeight type spin default "<<  nnueWeight << " min 0 max 200" << "\n";
     std::cout << "option name hceWeight type spin default " << hceWeight << " min 0 max 200" << "\n";
+    std::cout << "option name SliderAttacks type combo default " << sliderNames[GenerateMoves.GetSliderType()];
+    for (int type = sliderKindergarten; type < sliderTypeCount; type++)
+        std::cout << " var " << sliderNames[type];
+    std::cout << "\n";
     std::cout << "uciok\n" << std::flush;
 }
 
+// GUIs send the whole game before every search. Instead of
+// setting up the position and replaying all the moves each
+// time, we remember the last "position" command and, if the
+// new one extends it, we play only the new moves. Accumulator,
+// repetition list and hash key are then updated incrementally.
+// Board hash detects other commands changing the position.
+
+struct GameRecord {
+    std::string fen;
+    std::vector<std::string> moves;
+    Bitboard boardHash = 0;
+    bool isValid = false;
+};
+
+static GameRecord lastGame;
+
+static void PlayMove(Position* pos, const std::string& moveString) {
+
+    UndoData undo;
+
+    pos->DoMove(StringToMove(pos, moveString), &undo);
+    pos->TryMarkingIrreversible();
+}
+
 void OnPositionCommand(std::istringstream& stream, Position* pos) {
 
     std::string token, fen;
+    std::vector<std::string> moves;
+    size_t movesPlayed = 0;
     stream >> token;
 
     // Set starting position
@@ -109,23 +170,37 @@ void OnPositionCommand(std::istringstream& stream, Position* pos) {
             fen += token + " ";
     }
     
-    // Set position
-    const char* charFen = fen.c_str();
-    pos->Set(charFen);
+    // Read moves
+    while (stream >> token)
+        moves.push_back(token);
+
+    // Continue from the last position command if possible,
+    // otherwise set position
+    if (lastGame.isValid &&
+        fen == lastGame.fen &&
+        pos->boardHash == lastGame.boardHash &&
+        moves.size() >= lastGame.moves.size() &&
+        std::equal(lastGame.moves.begin(), lastGame.moves.end(), moves.begin()))
+        movesPlayed = lastGame.moves.size();
+    else
+        pos->Set(fen);
 
     // Execute moves
-    OnStepCommand(stream, pos);
+    for (size_t i = movesPlayed; i < moves.size(); i++)
+        PlayMove(pos, moves[i]);
+
+    lastGame.fen = fen;
+    lastGame.moves = std::move(moves);
+    lastGame.boardHash = pos->boardHash;
+    lastGame.isValid = true;
 }
 
 void OnStepCommand(std::istringstream& stream, Position* pos) {
 
     std::string token;
-    UndoData undo;
 
-    for (bool found = true; stream >> token && found;) {
-        pos->DoMove(StringToMove(pos, token), &undo);
-        pos->TryMarkingIrreversible();
-    }
+    while (stream >> token)
+        PlayMove(pos, token);
 }
 
 void OnGoCommand(std::istringstream& stream, Position* pos) {
@@ -230,34 +305,156 @@ void OnSetOptionCommand(std::istringstream& stream) {
         hceWeight = std::stoi(value);
     }
 
+    if (IsSameOrLowercase(name, "SliderAttacks")) {
+        for (int type = sliderKindergarten; type < sliderTypeCount; type++)
+            if (IsSameOrLowercase(value, sliderNames[type])
+            && !GenerateMoves.SetSliderType((SliderType)type))
+                std::cout << "info string " << value << " not compiled in, use USE_PEXT\n";
+    }
+
     if (IsSameOrLowercase(name, "NNUEfile")) {
         
         TryLoadingNNUE(value.c_str());
     }
 }
 
+// "bench [depth] [repeat n] [file name] [threads n] [json]"
+// searches the bench positions (or positions from the file,
+// one FEN per line) to the given depth, n times
 void OnBenchCommand(std::istringstream& stream, Position* pos) {
 
+    std::string param, fileName;
+    int depth = 4; // default
+    int repeats = 1;
+    int threads = 1;
+    bool asJson = false;
+
+    while (stream >> param) {
+        if (param == "repeat")
+            stream >> repeats;
+        else if (param == "file")
+            stream >> fileName;
+        else if (param == "threads")
+            stream >> threads;
+        else if (param == "json")
+            asJson = true;
+        else if (std::isdigit((unsigned char)param[0]))
+            depth = std::stoi(param);
+    }
+
+    if (!asJson)
+        std::cout << "Running bench at depth " << depth << "\n";
+
+    Bench(pos, depth, repeats, fileName, threads, asJson);
+}
+
+// "nnbench [depth] [directory]" times NNUE kernels for every
+// net in the directory, then replays accumulator updates
+// recorded while searching the current position
+void OnNnBenchCommand(std::istringstream& stream, Position* pos) {
+
+    int depth = 8; // default
+    std::string token, directory = ".";
+
+    while (stream >> token) {
+        if (std::isdigit(token[0])) depth = std::stoi(token);
+        else directory = token;
+    }
+
+    std::cout << "Running NNUE benchmark at depth " << depth << "\n";
+    NnBench(pos, depth, directory);
+}
+
+// "genbench [depth]" compares sliding attack generators:
+// raw lookups, move generation and perft to the given depth
+void OnGenBenchCommand(std::istringstream& stream) {
+
     int depth = 4; // default
     stream >> depth;
-    std::cout << "Running perft test at depth " << depth << "\n";
-    Bench(pos, depth);
+    std::cout << "Running move generator benchmark at depth " << depth << "\n";
+    GenBench(depth);
+}
+
+// "sortbench [depth]" times move picking on lists
+// recorded while searching the current position
+void OnSortBenchCommand(std::istringstream& stream, Position* pos) {
+
+    int depth = 10; // default
+    stream >> depth;
+    std::cout << "Running move ordering benchmark at depth " << depth << "\n";
+    SortBench(pos, depth);
+}
+
+// "epdsuite file [movetime ms | nodes n | depth n]" searches
+// EPD positions with bm/am operations (1 second each by default)
+void OnEpdSuiteCommand(std::istringstream& stream, Position* pos) {
+
+    std::string fileName, budget = "movetime";
+    size_t limit = 1000;
+    stream >> fileName >> budget >> limit;
+    std::cout << "Running test suite " << fileName << " with " << budget << " " << limit << "\n";
+    EpdSuite(pos, fileName, budget, limit);
 }
 
+// "evalbench file" times Evaluate() in each eval mode
+// on positions from the file (FEN or EPD, one per line)
+void OnEvalBenchCommand(std::istringstream& stream, Position* pos) {
+
+    std::string fileName;
+    stream >> fileName;
+    std::cout << "Running evaluation benchmark on " << fileName << "\n";
+    EvalBench(pos, fileName);
+}
+
+// "searchstats [json]" prints pruning, reduction and
+// extension counters collected during the last search
+// (or bench)
+void OnSearchStatsCommand(std::istringstream& stream) {
+
+    std::string format;
+    stream >> format;
+    Stats.Print(format == "json");
+}
+
+// "perft [depth] [threads]" - threads default to
+// the number of cores
 void OnPerftCommand(std::istringstream& stream, Position* pos) {
 
-    int moveCount;
+    Bitboard moveCount;
     int depth = 4; // default
-    stream >> depth;
-    std::cout << "Running perft test at depth " << depth << "\n";
+    int threads = std::max(1, (int)std::thread::hardware_concurrency());
+    stream >> depth >> threads;
+    std::cout << "Running perft test at depth " << depth 
+              << " using " << threads << " thread(s)\n";
 
     Timer.Start();
-    moveCount = Perft(pos, 0, depth, true);
+    moveCount = Perft(pos, depth, threads, true, true);
+    const int elapsed = Timer.Elapsed();
 
     std::cout << "Perft " << depth 
-              << " completed in " << Timer.Elapsed() 
+              << " completed in " << elapsed 
               << " milliseconds, visiting " << moveCount 
-              << " positions\n";
+              << " positions (" << moveCount / (1000.0 * std::max(elapsed, 1)) 
+              << " Mnps)\n";
+
+#ifdef VERIFY_NNUE
+    PrintVerificationCost(Timer.Elapsed());
+#endif
+}
+
+// "perftsuite <file> [maxDepth] [threads]" runs perft
+// for every position in the file, comparing results
+// with expected node counts
+void OnPerftSuiteCommand(std::istringstream& stream, Position* pos) {
+
+    std::string fileName;
+    int maxDepth = 6; // default
+    int threads = std::max(1, (int)std::thread::hardware_concurrency());
+    stream >> fileName >> maxDepth >> threads;
+    std::cout << "Running perft suite " << fileName << " up to depth " << maxDepth
+              << " using " << threads << " thread(s)\n";
+
+    PerftSuite(pos, fileName, maxDepth, threads);
 }
 
 void OnNewGame(void) {
@@ -284,6 +481,7 @@ void OnStopCommand() {
 void TryLoadingNNUE(const char * path) {
 
     isNNUEloaded = NN.LoadFromFile(path);
+    lastGame.isValid = false; // accumulator needs a refresh
     if (!isNNUEloaded)
         std::cout << "info string NNUE file " << path
         << " not found. Reverting to HCE eval." << "\n" << std::flush;
@@ -9,6 +9,13 @@ void OnGoCommand(std::istringstream& stream, Position* pos);
 void OnSetOptionCommand(std::istringstream& stream);
 void OnBenchCommand(std::istringstream& stream, Position* pos);
 void OnPerftCommand(std::istringstream& stream, Position* pos);
+void OnPerftSuiteCommand(std::istringstream& stream, Position* pos);
+void OnNnBenchCommand(std::istringstream& stream, Position* pos);
+void OnGenBenchCommand(std::istringstream& stream);
+void OnSortBenchCommand(std::istringstream& stream, Position* pos);
+void OnSearchStatsCommand(std::istringstream& stream);
+void OnEpdSuiteCommand(std::istringstream& stream, Position* pos);
+void OnEvalBenchCommand(std::istringstream& stream, Position* pos);
 std::string ToLower(const std::string& str);
 bool IsSameOrLowercase(const std::string& str1, const std::string& str2);
 void OnStopCommand();